@@ -31,7 +31,11 @@ namespace Settings
             CursorColor,
             CodeErrorColor,
             CodeSuccessColor,
-            SelectingColor;
+            SelectingColor,
+            KeywordColor,
+            StringColor,
+            CommentColor,
+            NumberColor;
     };
 
     struct Theme
@@ -50,15 +54,23 @@ namespace Settings
         DirectoriesFirstAlphabetDescending,
     };
 
+    enum class PixelFormats
+    {
+        Rgb565,
+        Rgb444,
+    };
+
     class Settings
     {
         static const std::map<Themes, Theme> themes;
         static Themes current_theme;
         static FilesSortingModes current_files_sorting;
+        static PixelFormats current_pixel_format;
         static nvs_handle_t nvs_handle;
         static esp_err_t RestoreSettings();
         static esp_err_t SaveTheme();
         static esp_err_t SaveFilesSortingMode();
+        static esp_err_t SavePixelFormat();
 
     public:
         static esp_err_t Init();
@@ -68,5 +80,8 @@ namespace Settings
 
         static FilesSortingModes GetFilesSortingMode();
         static void SetFilesSortingMode(FilesSortingModes mode);
+
+        static PixelFormats GetPixelFormat();
+        static void SetPixelFormat(PixelFormats format);
     };
 }
\ No newline at end of file
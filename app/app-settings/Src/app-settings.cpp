@@ -7,28 +7,36 @@ namespace Settings
     const std::map<Themes, Theme> Settings::themes{
         {Themes::Default,
          {Themes::Default, {
-                               Color::Black, // MainBackgroundColor
-                               Color::White, // SecondaryBackgroundColor
-                               Color::Blue,  // FocusedBackgroundColor
-                               Color::White, // MainTextColor
-                               Color::Black, // SecondaryTextColor
-                               Color::White, // FocusedTextColor
-                               Color::White, // CursorColor
-                               Color::Red,   // CodeErrorColor
-                               Color::Green, // CodeSuccessColor
-                               Color::Blue,  // SelectingColor
+                               Color::Black,  // MainBackgroundColor
+                               Color::White,  // SecondaryBackgroundColor
+                               Color::Blue,   // FocusedBackgroundColor
+                               Color::White,  // MainTextColor
+                               Color::Black,  // SecondaryTextColor
+                               Color::White,  // FocusedTextColor
+                               Color::White,  // CursorColor
+                               Color::Red,    // CodeErrorColor
+                               Color::Green,  // CodeSuccessColor
+                               Color::Blue,   // SelectingColor
+                               Color::Cyan,   // KeywordColor
+                               Color::Yellow, // StringColor
+                               Color::Gray,   // CommentColor
+                               Color::Orange, // NumberColor
                            }}},
         {Themes::Light, {Themes::Light, {
-                                            Color::White, // MainBackgroundColor
-                                            Color::Black, // SecondaryBackgroundColor
-                                            Color::Blue,  // FocusedBackgroundColor
-                                            Color::Black, // MainTextColor
-                                            Color::White, // SecondaryTextColor
-                                            Color::White, // FocusedTextColor
-                                            Color::Black, // CursorColor
-                                            Color::Red,   // CodeErrorColor
-                                            Color::Green, // CodeSuccessColor
-                                            Color::Blue,  // SelectingColor
+                                            Color::White,     // MainBackgroundColor
+                                            Color::Black,     // SecondaryBackgroundColor
+                                            Color::Blue,      // FocusedBackgroundColor
+                                            Color::Black,     // MainTextColor
+                                            Color::White,     // SecondaryTextColor
+                                            Color::White,     // FocusedTextColor
+                                            Color::Black,     // CursorColor
+                                            Color::Red,       // CodeErrorColor
+                                            Color::Green,     // CodeSuccessColor
+                                            Color::Blue,      // SelectingColor
+                                            Color::Blue,      // KeywordColor
+                                            Color::DarkGreen, // StringColor
+                                            Color::Gray,      // CommentColor
+                                            Color::Purple,    // NumberColor
                                         }}},
         {Themes::Green, {Themes::Green, {
                                             Color::DarkGreen,  // MainBackgroundColor
@@ -41,11 +49,16 @@ namespace Settings
                                             Color::Red,        // CodeErrorColor
                                             Color::Green,      // CodeSuccessColor
                                             Color::DarkYellow, // SelectingColor
+                                            Color::Cyan,       // KeywordColor
+                                            Color::Yellow,     // StringColor
+                                            Color::Gray,       // CommentColor
+                                            Color::Orange,     // NumberColor
                                         }}},
     };
 
     Themes Settings::current_theme{Themes::Default};
     FilesSortingModes Settings::current_files_sorting{FilesSortingModes::AlphabetAscending};
+    PixelFormats Settings::current_pixel_format{PixelFormats::Rgb565};
     nvs_handle_t Settings::nvs_handle{};
 
     esp_err_t Settings::Init()
@@ -84,6 +97,12 @@ namespace Settings
         SaveFilesSortingMode();
     }
 
+    void Settings::SetPixelFormat(PixelFormats format)
+    {
+        current_pixel_format = format;
+        SavePixelFormat();
+    }
+
     esp_err_t Settings::RestoreSettings()
     {
         esp_err_t ret{nvs_open("settings", NVS_READONLY, &nvs_handle)};
@@ -112,11 +131,22 @@ namespace Settings
                 SaveFilesSortingMode();
             }
 
+            ret = nvs_get_i8(nvs_handle, "pxfmt", &buffer);
+            if (ret == ESP_OK)
+            {
+                ESP_LOGD(TAG, "Read pixel format from NVS: %d", buffer);
+                current_pixel_format = (PixelFormats)buffer;
+            }
+            else if (ret == ESP_ERR_NVS_NOT_FOUND)
+            {
+                SavePixelFormat();
+            }
+
             nvs_close(nvs_handle);
         }
         else if (ret == ESP_ERR_NVS_NOT_FOUND)
         {
-            ret = SaveTheme() | SaveFilesSortingMode();
+            ret = SaveTheme() | SaveFilesSortingMode() | SavePixelFormat();
         }
 
         return ret;
@@ -156,8 +186,30 @@ namespace Settings
         return ret;
     }
 
+    esp_err_t Settings::SavePixelFormat()
+    {
+        esp_err_t ret{nvs_open("settings", NVS_READWRITE, &nvs_handle)};
+        if (ret == ESP_OK)
+        {
+            ret = nvs_set_i8(nvs_handle, "pxfmt", (int8_t)current_pixel_format);
+            if (ret == ESP_OK)
+            {
+                ESP_LOGD(TAG, "Save pixel format into NVS: %d", (int8_t)current_pixel_format);
+            }
+
+            nvs_close(nvs_handle);
+        }
+
+        return ret;
+    }
+
     FilesSortingModes Settings::GetFilesSortingMode()
     {
         return current_files_sorting;
     }
+
+    PixelFormats Settings::GetPixelFormat()
+    {
+        return current_pixel_format;
+    }
 }
\ No newline at end of file
@@ -1,5 +1,8 @@
 #include "display.h"
 
+#include <algorithm>
+#include <inttypes.h>
+
 static const char *TAG = "Display";
 
 namespace Display
@@ -43,13 +46,16 @@ namespace Display
 
     esp_err_t DisplayController::Init()
     {
+        int64_t fonts_start{esp_timer_get_time()};
         esp_err_t ret = initFonts();
         if (ret != ESP_OK)
         {
             return ret;
         }
+        ESP_LOGI(TAG, "Fonts ready in %lld us", esp_timer_get_time() - fonts_start);
 
         lcd.Init(240, 320);
+        SetPixelFormat(Settings::Settings::GetPixelFormat());
         BacklightOn();
 
         return ESP_OK;
@@ -98,18 +104,41 @@ namespace Display
 
     esp_err_t DisplayController::initFonts()
     {
-        if (ESP_OK != mountSPIFFS("/fonts", "storage1", 4))
+        FontxFile *fonts[]{fx16G, fx24G, fx32G, fx32L, fx16M, fx24M, fx32M};
+        static_assert(std::size(fonts) == std::size(font_descriptors));
+        bool spiffs_mounted{false};
+
+        for (size_t i = 0; i < std::size(fonts); i++)
         {
-            return ESP_FAIL;
-        }
+            const FontDescriptor &descriptor{font_descriptors[i]};
+            const FontxEmbedded *embedded{FindEmbeddedFontx(descriptor.path)};
+
+            // SPIFFS is mounted only for fonts not linked into flash
+            if (embedded != nullptr)
+            {
+                Font::InitEmbeddedFontx(fonts[i], embedded->name, embedded->start, embedded->end);
+            }
+            else
+            {
+                if (!spiffs_mounted)
+                {
+                    if (ESP_OK != mountSPIFFS("/fonts", "storage1", 8))
+                    {
+                        return ESP_FAIL;
+                    }
+                    spiffs_mounted = true;
+                }
+
+                Font::InitFontx(fonts[i], descriptor.path, "");
+            }
 
-        Font::InitFontx(fx16G, "/fonts/ILGH16XB.FNT", "");
-        Font::InitFontx(fx24G, "/fonts/ILGH24XB.FNT", "");
-        Font::InitFontx(fx32G, "/fonts/ILGH32XB.FNT", "");
-        Font::InitFontx(fx32L, "/fonts/LATIN32B.FNT", "");
-        Font::InitFontx(fx16M, "/fonts/ILMH16XB.FNT", "");
-        Font::InitFontx(fx24M, "/fonts/ILMH24XB.FNT", "");
-        Font::InitFontx(fx32M, "/fonts/ILMH32XB.FNT", "");
+            const FontxMetrics &metrics{Font::GetMetrics(fonts[i])};
+            if (metrics.w != descriptor.metrics.w || metrics.h != descriptor.metrics.h)
+            {
+                ESP_LOGW(TAG, "Font %s is %dx%d, expected %dx%d", descriptor.path,
+                         metrics.w, metrics.h, descriptor.metrics.w, descriptor.metrics.h);
+            }
+        }
 
         return ESP_OK;
     }
@@ -126,15 +155,11 @@ namespace Display
             y2 = GetHeight();
         }
 
-        lcd.DrawFillRect(y, x, y2, x2, color);
+        fillRect(y, x, y2, x2, color);
     }
 
     void DisplayController::DrawStringItem(UiStringItem *item, Position hp, Position vp)
     {
-        uint8_t fw, fh;
-        Font::GetFontx(item->font, 0, &fw, &fh);
-        uint16_t label_width = fw * item->label.size();
-
         SetPosition(item, hp, vp);
 
         if (!item->displayable)
@@ -142,18 +167,20 @@ namespace Display
             return;
         }
 
-        if (item->backgroundColor != Color::None)
-        {
-            lcd.DrawFillRect(
-                item->y,
-                item->x,
-                item->y + fh,
-                item->x + label_width,
-                item->backgroundColor);
-        }
-
         lcd.SetFontDirection(1);
-        lcd.DrawString(item->font, item->y, item->x, (uint8_t *)item->label.c_str(), item->color);
+        drawLabel(item);
+    }
+
+    // Draw item label, background goes in the same transfer as glyphs
+    void DisplayController::drawLabel(UiStringItem *item)
+    {
+        drawString(item->font, item->y, item->x, item->label.c_str(), item->color, item->backgroundColor);
+    }
+
+    // Draw text at x, y, background fills glyph cells
+    void DisplayController::DrawText(FontxFile *font, uint16_t x, uint16_t y, const char *text, Color color, Color background)
+    {
+        drawString(font, y, x, text, color, background);
     }
 
     void DisplayController::DrawStringItems(
@@ -165,7 +192,6 @@ namespace Display
     {
         lcd.SetFontDirection(1);
         SetListPositions(start, end, x, y, max_count);
-        uint8_t fw, fh;
 
         for (auto it = start; it < end; it++)
         {
@@ -175,14 +201,7 @@ namespace Display
                 continue;
             }
 
-            Font::GetFontx(it->font, 0, &fw, &fh);
-            uint16_t width = it->label.size() * fw;
-
-            if (it->backgroundColor != Color::None)
-            {
-                lcd.DrawFillRect(it->y, it->x, it->y + fh, it->x + width, it->backgroundColor);
-            }
-            lcd.DrawString(it->font, it->y, it->x, (uint8_t *)it->label.c_str(), it->color);
+            drawLabel(&*it);
             ESP_LOGD(TAG, "Displaying item %s, x: %d, y: %d", it->label.c_str(), x, y);
         }
     }
@@ -205,7 +224,7 @@ namespace Display
                 continue;
             }
 
-            Font::GetFontx(it->font, 0, 0, &fh);
+            Font::GetFontSize(it->font, 0, &fh);
 
             it->x = x;
             it->y = y;
@@ -228,6 +247,239 @@ namespace Display
         }
     }
 
+    // Switch pixel format of transfers, panel content stays as it is
+    void DisplayController::SetPixelFormat(Settings::PixelFormats format)
+    {
+        lcd.SetPixelFormat(format == Settings::PixelFormats::Rgb444
+                               ? LCD::PIXEL_FORMAT_RGB444
+                               : LCD::PIXEL_FORMAT_RGB565);
+    }
+
+    // Move area content by dy along Y, exposed band has to be redrawn by caller
+    // Returns false without frame buffer, panel content can't be moved then,
+    // redraw the area instead.
+    bool DisplayController::ScrollArea(uint16_t x, uint16_t y, uint16_t x2, uint16_t y2, int16_t dy)
+    {
+        // Shift moves what is already drawn, so recorded commands go first
+        if (isRecording())
+        {
+            submitDisplayList();
+        }
+        dropCursorTile(y, x, y2, x2);
+        return lcd.ShiftArea(y, x, y2, x2, dy);
+    }
+
+    // Start recording draw calls, they are optimized and drawn on Flush
+    void DisplayController::BeginFrame()
+    {
+#if CONFIG_DISPLAY_LIST
+        recording = true;
+        frame_task = xTaskGetCurrentTaskHandle();
+        frame_stats = DisplayListStats{};
+#endif
+    }
+
+    // Draw recorded frame and push frame buffer changes to panel
+    void DisplayController::Flush()
+    {
+        if (isRecording())
+        {
+            submitDisplayList();
+            recording = false;
+        }
+        lcd.DrawFinish();
+    }
+
+    // Draw to frame buffer while a scene scrolls its content, see ScrollArea
+    // Screen is cleared to background, scene has to redraw it after.
+    bool DisplayController::EnableFrameBuffer()
+    {
+        if (!lcd.EnableFrameBuffer())
+        {
+            return false;
+        }
+
+        Clear(Settings::Settings::GetTheme().Colors.MainBackgroundColor);
+        return true;
+    }
+
+    void DisplayController::DisableFrameBuffer()
+    {
+        lcd.DisableFrameBuffer();
+    }
+
+    // Get counters of the last frame, summed over lists it submitted
+    DisplayListStats DisplayController::GetFrameStats()
+    {
+        return frame_stats;
+    }
+
+    bool DisplayController::isRecording()
+    {
+        return recording && frame_task == xTaskGetCurrentTaskHandle();
+    }
+
+    void DisplayController::fillRect(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2, Color color)
+    {
+        dropCursorTile(x1, y1, x2, y2);
+
+        if (!isRecording())
+        {
+            lcd.DrawFillRect(x1, y1, x2, y2, color);
+            return;
+        }
+
+        if (x1 >= lcd.width || y1 >= lcd.height || x2 < x1 || y2 < y1)
+            return;
+
+        display_list.push_back(DrawCommand{
+            .type = DrawCommand::Type::Fill,
+            .x1 = x1,
+            .y1 = y1,
+            .x2 = std::min<uint16_t>(x2, lcd.width - 1),
+            .y2 = std::min<uint16_t>(y2, lcd.height - 1),
+            .color = color,
+            .background = color,
+        });
+    }
+
+    // Draw string at panel x, y in font direction 1
+    void DisplayController::drawString(FontxFile *font, uint16_t x, uint16_t y, const char *text, Color color, Color background)
+    {
+        uint8_t fw, fh;
+        Font::GetFontSize(font, &fw, &fh);
+        size_t length{strlen(text)};
+        dropCursorTile(x, y, x + fh, y + length * fw);
+
+        if (!isRecording())
+        {
+            lcd.SetFontDirection(1);
+            if (background != Color::None)
+            {
+                lcd.SetFontFill(background);
+            }
+
+            lcd.DrawString(font, x, y, (uint8_t *)text, color);
+            lcd.UnsetFontFill();
+            return;
+        }
+
+        if (length == 0 || x >= lcd.width || y >= lcd.height)
+            return;
+
+        // Glyph cells and font fill go from x to x + fh - 1
+        display_list.push_back(DrawCommand{
+            .type = DrawCommand::Type::Text,
+            .x1 = x,
+            .y1 = y,
+            .x2 = static_cast<uint16_t>(std::min<int>(x + fh - 1, lcd.width - 1)),
+            .y2 = static_cast<uint16_t>(std::min<int>(y + length * fw - 1, lcd.height - 1)),
+            .color = color,
+            .background = background,
+            .font = font,
+            .text = text,
+        });
+    }
+
+    void DisplayController::submit(const DrawCommand &command)
+    {
+        if (command.type == DrawCommand::Type::Fill)
+        {
+            lcd.DrawFillRect(command.x1, command.y1, command.x2, command.y2, command.color);
+            return;
+        }
+
+        lcd.SetFontDirection(1);
+        if (command.background != Color::None)
+        {
+            lcd.SetFontFill(command.background);
+        }
+
+        lcd.DrawString(command.font, command.x1, command.y1, (uint8_t *)command.text.c_str(), command.color);
+        lcd.UnsetFontFill();
+    }
+
+    // Draw recorded commands, skipping ones painted over later in the frame
+    // and merging adjacent fills of one color
+    void DisplayController::submitDisplayList()
+    {
+        if (display_list.empty())
+            return;
+
+        auto area = [](const DrawCommand &command)
+        {
+            return static_cast<uint32_t>(command.x2 - command.x1 + 1) * (command.y2 - command.y1 + 1);
+        };
+
+        DisplayListStats stats{.commands = static_cast<uint32_t>(display_list.size())};
+
+        for (size_t i = 0; i < display_list.size(); i++)
+        {
+            DrawCommand &command{display_list[i]};
+            stats.pixels_recorded += area(command);
+
+            for (size_t j = i + 1; j < display_list.size() && !command.dropped; j++)
+            {
+                const DrawCommand &later{display_list[j]};
+                if (later.background == Color::None)
+                    continue;
+
+                command.dropped = later.x1 <= command.x1 && later.y1 <= command.y1 &&
+                                  later.x2 >= command.x2 && later.y2 >= command.y2;
+            }
+        }
+
+        DrawCommand *pending{nullptr};
+        for (auto &command : display_list)
+        {
+            if (command.dropped)
+                continue;
+
+            if (pending != nullptr &&
+                pending->type == DrawCommand::Type::Fill &&
+                command.type == DrawCommand::Type::Fill &&
+                pending->color == command.color)
+            {
+                bool rows_match{pending->x1 == command.x1 && pending->x2 == command.x2 &&
+                                (pending->y2 + 1 == command.y1 || command.y2 + 1 == pending->y1)};
+                bool columns_match{pending->y1 == command.y1 && pending->y2 == command.y2 &&
+                                   (pending->x2 + 1 == command.x1 || command.x2 + 1 == pending->x1)};
+
+                if (rows_match || columns_match)
+                {
+                    pending->x1 = std::min(pending->x1, command.x1);
+                    pending->y1 = std::min(pending->y1, command.y1);
+                    pending->x2 = std::max(pending->x2, command.x2);
+                    pending->y2 = std::max(pending->y2, command.y2);
+                    continue;
+                }
+            }
+
+            if (pending != nullptr)
+            {
+                submit(*pending);
+                stats.submitted++;
+                stats.pixels_submitted += area(*pending);
+            }
+            pending = &command;
+        }
+
+        if (pending != nullptr)
+        {
+            submit(*pending);
+            stats.submitted++;
+            stats.pixels_submitted += area(*pending);
+        }
+
+        display_list.clear();
+        frame_stats.commands += stats.commands;
+        frame_stats.submitted += stats.submitted;
+        frame_stats.pixels_recorded += stats.pixels_recorded;
+        frame_stats.pixels_submitted += stats.pixels_submitted;
+        ESP_LOGD(TAG, "Frame: %" PRIu32 "/%" PRIu32 " commands, %" PRIu32 "/%" PRIu32 " pixels drawn",
+                 stats.submitted, stats.commands, stats.pixels_submitted, stats.pixels_recorded);
+    }
+
     uint16_t DisplayController::GetWidth()
     {
         return lcd.height;
@@ -238,9 +490,104 @@ namespace Display
         return lcd.width;
     }
 
-    void DisplayController::DrawCursor(uint16_t x, uint16_t y, uint8_t width, uint8_t height)
+    // Draw cursor and save the area under it, so it can be hidden without text redraw
+    void DisplayController::DrawCursor(uint16_t x, uint16_t y, uint8_t width, uint8_t height, const CursorCell &cell)
+    {
+        // Tile is taken from what is on the panel, so recorded commands go first
+        if (isRecording())
+        {
+            submitDisplayList();
+        }
+
+        uint16_t x1{y}, y1{x};
+        uint16_t x2{static_cast<uint16_t>(std::min<int>(y + height, lcd.width - 1))};
+        uint16_t y2{static_cast<uint16_t>(std::min<int>(x + width, lcd.height - 1))};
+        auto color{Settings::Settings::GetTheme().Colors.CursorColor};
+
+        cursor_tile.saved = false;
+        if (x1 >= lcd.width || y1 >= lcd.height)
+        {
+            return;
+        }
+
+        if (cell.font != nullptr && static_cast<size_t>(x2 - x1 + 1) * (y2 - y1 + 1) <= CURSOR_TILE_PIXELS)
+        {
+            lcd.SetFontDirection(1);
+            lcd.GetTextRect(cell.font, cell.y, cell.x, cell.c, cell.color, cell.background,
+                            x1, y1, x2, y2, cursor_tile.pixels);
+            cursor_tile.x1 = x1;
+            cursor_tile.y1 = y1;
+            cursor_tile.x2 = x2;
+            cursor_tile.y2 = y2;
+            cursor_tile.cell = cell;
+            cursor_tile.saved = true;
+        }
+
+        lcd.DrawFillRect(x1, y1, x2, y2, color);
+        cursor_tile.visible = true;
+    }
+
+    // Put saved area back over the cursor
+    // Returns false when nothing matching cell at (x, y) is saved, redraw the cell then.
+    bool DisplayController::ClearCursor(uint16_t x, uint16_t y, const CursorCell &cell)
     {
-        lcd.DrawFillRect(y, x, y + height, x + width, Settings::Settings::GetTheme().Colors.CursorColor);
+        if (!cursor_tile.saved || cursor_tile.x1 != y || cursor_tile.y1 != x ||
+            cursor_tile.cell.font != cell.font || cursor_tile.cell.c != cell.c ||
+            cursor_tile.cell.color != cell.color || cursor_tile.cell.background != cell.background ||
+            cursor_tile.cell.x != cell.x || cursor_tile.cell.y != cell.y)
+        {
+            return false;
+        }
+
+        if (cursor_tile.visible)
+        {
+            if (isRecording())
+            {
+                submitDisplayList();
+            }
+            lcd.SetRect(cursor_tile.x1, cursor_tile.y1, cursor_tile.x2, cursor_tile.y2, cursor_tile.pixels);
+        }
+
+        cursor_tile.saved = false;
+        return true;
+    }
+
+    // Toggle cursor over its saved area
+    // Returns false when the area under cursor was drawn over, render cursor again then.
+    bool DisplayController::BlinkCursor()
+    {
+        if (!cursor_tile.saved)
+        {
+            return false;
+        }
+
+        if (isRecording())
+        {
+            submitDisplayList();
+        }
+
+        if (cursor_tile.visible)
+        {
+            lcd.SetRect(cursor_tile.x1, cursor_tile.y1, cursor_tile.x2, cursor_tile.y2, cursor_tile.pixels);
+        }
+        else
+        {
+            lcd.DrawFillRect(cursor_tile.x1, cursor_tile.y1, cursor_tile.x2, cursor_tile.y2,
+                             Settings::Settings::GetTheme().Colors.CursorColor);
+        }
+        cursor_tile.visible = !cursor_tile.visible;
+        return true;
+    }
+
+    // Saved cursor area is stale once anything else draws over it
+    void DisplayController::dropCursorTile(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2)
+    {
+        if (cursor_tile.saved &&
+            x1 <= cursor_tile.x2 && x2 >= cursor_tile.x1 &&
+            y1 <= cursor_tile.y2 && y2 >= cursor_tile.y1)
+        {
+            cursor_tile.saved = false;
+        }
     }
 
     void DisplayController::DrawListEndingLabel(
@@ -248,8 +595,8 @@ namespace Display
         size_t count,
         const char *end_label)
     {
-        uint8_t fw, fh;
-        Font::GetFontx(line_before->font, 0, &fw, &fh);
+        uint8_t fh;
+        Font::GetFontSize(line_before->font, 0, &fh);
         char label[30]{0};
         snprintf(label, 29, "%d %s", count, end_label);
 
@@ -257,18 +604,13 @@ namespace Display
 
         auto &theme{Settings::Settings::GetTheme()};
 
-        lcd.DrawFillRect(item_y, item_x,
-                         item_y + fh,
-                         item_x + strlen(label) * fw,
-                         theme.Colors.SecondaryBackgroundColor);
-
-        lcd.DrawString(fx16G, item_y, item_x, (uint8_t *)label, theme.Colors.SecondaryTextColor);
+        drawString(fx16G, item_y, item_x, label, theme.Colors.SecondaryTextColor, theme.Colors.SecondaryBackgroundColor);
     }
 
     void DisplayController::SetPosition(UiStringItem *item, Position hp, Position vp)
     {
         uint8_t fw, fh;
-        Font::GetFontx(item->font, 0, &fw, &fh);
+        Font::GetFontSize(item->font, &fw, &fh);
         uint16_t label_width = fw * item->label.size();
 
         switch (hp)
@@ -304,7 +646,7 @@ namespace Display
 
     void DisplayController::DrawSelecting(uint16_t start_x, uint16_t start_y, uint16_t end_x, uint16_t end_y)
     {
-        lcd.DrawFillRect(start_y, start_x, end_y, end_x, Settings::Settings::GetTheme().Colors.SelectingColor);
+        fillRect(start_y, start_x, end_y, end_x, Settings::Settings::GetTheme().Colors.SelectingColor);
     }
 
     void DisplayController::BacklightOn()
@@ -1,18 +1,39 @@
 #pragma once
 #include "st7789v.h"
 #include "fontx.h"
+#include "fontx-embedded.h"
 #include "esp_spiffs.h"
 #include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
 #include <vector>
 #include <string>
 #include <cstring>
 
 #include "app-settings.h"
 
-using Fontx::Font, Fontx::FontxFile, LCD::Color;
+using Fontx::Font, Fontx::FontxFile, Fontx::FontxMetrics, Fontx::MakeFontxMetrics, Fontx::FontxEmbedded, Fontx::FindEmbeddedFontx, LCD::Color;
 
 namespace Display
 {
+    struct FontDescriptor
+    {
+        const char *path;
+        FontxMetrics metrics;
+    };
+
+    // Fonts linked into flash or on the "storage1" partition, in DisplayController member order
+    constexpr FontDescriptor font_descriptors[]{
+        {"/fonts/ILGH16XB.FNT", MakeFontxMetrics(8, 16)},
+        {"/fonts/ILGH24XB.FNT", MakeFontxMetrics(12, 24)},
+        {"/fonts/ILGH32XB.FNT", MakeFontxMetrics(16, 32)},
+        {"/fonts/LATIN32B.FNT", MakeFontxMetrics(16, 32)},
+        {"/fonts/ILMH16XB.FNT", MakeFontxMetrics(8, 16)},
+        {"/fonts/ILMH24XB.FNT", MakeFontxMetrics(12, 24)},
+        {"/fonts/ILMH32XB.FNT", MakeFontxMetrics(16, 32)},
+    };
+
     struct UiStringItem
     {
         uint32_t id;
@@ -36,6 +57,49 @@ namespace Display
                      uint16_t y = 0);
     };
 
+    // Draw call recorded while a frame is open, area is in panel coordinates
+    struct DrawCommand
+    {
+        enum class Type
+        {
+            Fill,
+            Text,
+        } type;
+        uint16_t x1, y1, x2, y2; // covered area, inclusive
+        Color color;
+        Color background; // Text: font fill, None when transparent
+        FontxFile *font;
+        std::string text;
+        bool dropped;
+    };
+
+    struct DisplayListStats
+    {
+        uint32_t commands, submitted;
+        uint32_t pixels_recorded, pixels_submitted;
+    };
+
+    // Character under the cursor, x and y are where its text is drawn
+    struct CursorCell
+    {
+        FontxFile *font;
+        char c;
+        Color color, background;
+        uint16_t x, y;
+    };
+
+    // Enough for the cursor of the biggest font
+    constexpr size_t CURSOR_TILE_PIXELS{(16 + 1) * (32 + 1)};
+
+    // Panel area under the cursor, saved when the cursor is drawn
+    struct CursorTile
+    {
+        uint16_t x1, y1, x2, y2; // panel coordinates, inclusive
+        CursorCell cell;
+        bool saved, visible;
+        uint16_t pixels[CURSOR_TILE_PIXELS];
+    };
+
     enum class Position
     {
         Start,
@@ -51,6 +115,19 @@ namespace Display
 
         esp_err_t mountSPIFFS(const char *path, const char *label, size_t max_files);
         esp_err_t initFonts();
+        void drawLabel(UiStringItem *item);
+        void fillRect(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2, Color color);
+        void drawString(FontxFile *font, uint16_t x, uint16_t y, const char *text, Color color, Color background);
+        void submit(const DrawCommand &command);
+        void submitDisplayList();
+        bool isRecording();
+        void dropCursorTile(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2);
+
+        std::vector<DrawCommand> display_list{};
+        bool recording{};
+        TaskHandle_t frame_task{}; // code log tasks draw directly, outside of frame
+        DisplayListStats frame_stats{};
+        CursorTile cursor_tile{};
 
     public:
         FontxFile fx16G[2], fx24G[2], fx32G[2], fx32L[2], fx16M[2], fx24M[2], fx32M[2];
@@ -84,14 +161,27 @@ namespace Display
             int16_t y,
             uint8_t max_count);
 
+        void DrawText(FontxFile *font, uint16_t x, uint16_t y, const char *text, Color color, Color background);
+
         void DrawListEndingLabel(std::vector<UiStringItem>::iterator line,
                                  size_t count,
                                  const char *end_label = "more items...");
 
-        void DrawCursor(uint16_t x, uint16_t y, uint8_t width = 10, uint8_t height = 15);
+        bool ScrollArea(uint16_t x, uint16_t y, uint16_t x2, uint16_t y2, int16_t dy);
+
+        void DrawCursor(uint16_t x, uint16_t y, uint8_t width, uint8_t height, const CursorCell &cell);
+        bool ClearCursor(uint16_t x, uint16_t y, const CursorCell &cell);
+        bool BlinkCursor();
         void DrawSelecting(uint16_t start_x, uint16_t start_y, uint16_t end_x, uint16_t end_y);
         uint16_t GetWidth();
         uint16_t GetHeight();
+        void SetPixelFormat(Settings::PixelFormats format);
+
+        void BeginFrame();
+        void Flush();
+        bool EnableFrameBuffer();
+        void DisableFrameBuffer();
+        DisplayListStats GetFrameStats();
 
         void BacklightOff();
         void BacklightOn();
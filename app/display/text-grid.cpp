@@ -0,0 +1,199 @@
+#include "text-grid.h"
+
+#include <algorithm>
+
+static const char *TAG = "TextGrid";
+
+namespace Display
+{
+    // Spaces look the same whatever text color is
+    bool TextGrid::Cell::operator==(const Cell &other) const
+    {
+        return c == other.c &&
+               background == other.background &&
+               (color == other.color || c == ' ');
+    }
+
+    bool TextGrid::Cell::operator!=(const Cell &other) const
+    {
+        return !(*this == other);
+    }
+
+    TextGrid::TextGrid(DisplayController &_display) : display{_display} {}
+
+    // Start grid over area already showing only background
+    // Row r is at y - r * font height, as lines placed by SetListPositions
+    void TextGrid::Reset(FontxFile *font, int16_t x, int16_t y, uint8_t rows, Color background)
+    {
+        Font::GetFontSize(font, &fw, &fh);
+
+        this->font = font;
+        this->x = x;
+        this->y = y;
+        this->rows = rows;
+        columns = (display.GetWidth() - x) / fw;
+
+        cells.assign(static_cast<size_t>(columns) * rows, Cell{' ', Color::None, background});
+        valid = true;
+
+        ESP_LOGD(TAG, "Reset grid %dx%d at x: %d, y: %d", columns, rows, x, y);
+    }
+
+    bool TextGrid::IsValid(FontxFile *font, int16_t x, int16_t y)
+    {
+        return valid && this->font == font && this->x == x && this->y == y;
+    }
+
+    // Screen no longer matches grid, it has to be reset
+    void TextGrid::Invalidate()
+    {
+        valid = false;
+    }
+
+    // Cells were drawn over outside of grid, they are drawn again on next SetRow
+    void TextGrid::Invalidate(uint8_t row, uint8_t column, uint8_t count)
+    {
+        if (row >= rows || column >= columns)
+            return;
+
+        if (count > columns - column)
+        {
+            count = columns - column;
+        }
+
+        std::fill_n(getRow(row) + column, count, Cell{});
+    }
+
+    // Record row already drawn on screen
+    void TextGrid::SyncRow(uint8_t row, const std::string &text, Color color, Color background)
+    {
+        if (row >= rows)
+            return;
+
+        Cell *line{getRow(row)};
+        for (uint8_t column = 0; column < columns; column++)
+        {
+            line[column] = Cell{column < text.size() ? text[column] : ' ', color, background};
+        }
+    }
+
+    // Draw row text, only cells differing from screen are drawn
+    void TextGrid::SetRow(uint8_t row, const std::string &text, Color color, Color background)
+    {
+        ColorRun run{UINT8_MAX, color};
+        SetRow(row, text, &run, 1, background);
+    }
+
+    // Draw row text colored by runs, cells past runs take color of last one
+    void TextGrid::SetRow(uint8_t row, const std::string &text, const ColorRun *runs, size_t count, Color background)
+    {
+        if (row >= rows || !count)
+            return;
+
+        Cell *line{getRow(row)};
+        size_t run_index{0};
+        uint8_t run_left{runs[0].length};
+
+        auto get_cell = [&](uint8_t column)
+        {
+            while (!run_left && run_index + 1 < count)
+            {
+                run_left = runs[++run_index].length;
+            }
+
+            if (run_left)
+            {
+                run_left--;
+            }
+
+            return Cell{column < text.size() ? text[column] : ' ', runs[run_index].color, background};
+        };
+
+        uint8_t column{0};
+        Cell cell{get_cell(column)};
+
+        while (column < columns)
+        {
+            if (line[column] == cell)
+            {
+                if (++column < columns)
+                {
+                    cell = get_cell(column);
+                }
+                continue;
+            }
+
+            uint8_t run_start{column};
+            Color color{cell.color};
+            run.clear();
+
+            // Spaces join run whatever their color is
+            while (column < columns && line[column] != cell && (cell.color == color || cell.c == ' '))
+            {
+                cell.color = color;
+                line[column] = cell;
+                run.push_back(cell.c);
+
+                if (++column < columns)
+                {
+                    cell = get_cell(column);
+                }
+            }
+
+            drawRun(row, run_start, color, background);
+        }
+    }
+
+    // Area content was moved on screen, row r now shows what row r + count did
+    // Only first scroll_rows rows were moved, rows moved in from outside are unknown.
+    void TextGrid::Scroll(int16_t count, uint8_t scroll_rows)
+    {
+        if (scroll_rows > rows)
+        {
+            scroll_rows = rows;
+        }
+
+        auto move_row = [this, count, scroll_rows](int16_t row)
+        {
+            int16_t source{static_cast<int16_t>(row + count)};
+            if (source < 0 || source >= scroll_rows)
+            {
+                Invalidate(row);
+                return;
+            }
+
+            std::copy_n(getRow(source), columns, getRow(row));
+        };
+
+        if (count > 0)
+        {
+            for (int16_t row = 0; row < scroll_rows; row++)
+                move_row(row);
+        }
+        else if (count < 0)
+        {
+            for (int16_t row = scroll_rows - 1; row >= 0; row--)
+                move_row(row);
+        }
+    }
+
+    uint8_t TextGrid::GetColumns()
+    {
+        return columns;
+    }
+
+    uint8_t TextGrid::GetRows()
+    {
+        return rows;
+    }
+
+    TextGrid::Cell *TextGrid::getRow(uint8_t row)
+    {
+        return &cells[static_cast<size_t>(row) * columns];
+    }
+
+    void TextGrid::drawRun(uint8_t row, uint8_t column, Color color, Color background)
+    {
+        display.DrawText(font, x + column * fw, y - row * fh, run.c_str(), color, background);
+    }
+}
@@ -0,0 +1,59 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <cstdint>
+
+#include "display.h"
+
+namespace Display
+{
+    // Chars of row drawn in one color
+    struct ColorRun
+    {
+        uint8_t length;
+        Color color;
+    };
+
+    // Fixed-width text area, remembers chars and colors every cell shows on
+    // screen, so only changed cells are drawn again. Adjacent changed cells of
+    // the same colors are drawn as one string.
+    class TextGrid
+    {
+        struct Cell
+        {
+            char c{};
+            Color color{Color::None}, background{Color::None}; // None background - unknown
+
+            bool operator==(const Cell &other) const;
+            bool operator!=(const Cell &other) const;
+        };
+
+        DisplayController &display;
+        FontxFile *font{};
+        int16_t x{}, y{};
+        uint8_t fw{}, fh{};
+        uint8_t columns{}, rows{};
+        bool valid{};
+        std::vector<Cell> cells{};
+        std::string run{};
+
+        Cell *getRow(uint8_t row);
+        void drawRun(uint8_t row, uint8_t column, Color color, Color background);
+
+    public:
+        TextGrid(DisplayController &display);
+
+        void Reset(FontxFile *font, int16_t x, int16_t y, uint8_t rows, Color background);
+        bool IsValid(FontxFile *font, int16_t x, int16_t y);
+        void Invalidate();
+        void Invalidate(uint8_t row, uint8_t column = 0, uint8_t count = UINT8_MAX);
+
+        void SyncRow(uint8_t row, const std::string &text, Color color, Color background);
+        void SetRow(uint8_t row, const std::string &text, Color color, Color background);
+        void SetRow(uint8_t row, const std::string &text, const ColorRun *runs, size_t count, Color background);
+        void Scroll(int16_t count, uint8_t scroll_rows);
+
+        uint8_t GetColumns();
+        uint8_t GetRows();
+    };
+}
@@ -10,7 +10,8 @@ namespace Scene
     {
         CodeEnterStage,
         LanguageChooseModalStage,
-        CodeRunModalStage
+        CodeRunModalStage,
+        FindModalStage,
     };
 
     class CodeScene : public Scene
@@ -46,6 +47,6 @@ namespace Scene
         void Delete() override;
         void Value(char value) override;
 
-        ~CodeScene() = default;
+        ~CodeScene();
     };
 }
\ No newline at end of file
@@ -17,6 +17,7 @@ namespace Scene
         CreateModalStage,
         RenameModalStage,
         CodeRunModalStage,
+        FindModalStage,
     };
 
     class FilesScene : public Scene
@@ -32,11 +33,12 @@ namespace Scene
         const size_t max_filename_size{8};
         const size_t max_filename_ext_size{3};
         std::vector<UiStringItem> directory_backup{};
+        Viewport directory_viewport{};
         CodeLanguage runner_language{CodeLanguage::Text};
 
         void OpenDirectory(const char *relative_path);
         size_t ReadDirectory();
-        void ReadFile(std::string path);
+        bool ReadFile(std::string path);
         void SaveDirectory();
 
         void OpenFile(const char *relative_path);
@@ -90,6 +92,9 @@ namespace Scene
         void Copy() override;
         void Cut() override;
         void Paste() override;
+        bool Undo() override;
+        bool Redo() override;
+        size_t ReplaceAll(const std::string &replacement, bool rerender = true) override;
 
         void CopyFile();
         void PasteFile();
@@ -103,6 +108,6 @@ namespace Scene
         SceneId Escape() override;
         void Delete() override;
 
-        ~FilesScene() = default;
+        ~FilesScene();
     };
 }
\ No newline at end of file
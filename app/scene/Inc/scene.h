@@ -11,6 +11,12 @@
 #include "esp_log.h"
 
 #include "display.h"
+#include "text-grid.h"
+#include "text-buffer.h"
+#include "wrap-index.h"
+#include "undo-journal.h"
+#include "syntax-highlighter.h"
+#include "text-finder.h"
 #include "keyboard.h"
 #include "runner.h"
 
@@ -18,6 +24,9 @@ using LCD::Color,
     Display::DisplayController,
     Display::UiStringItem,
     Display::Position,
+    Display::TextGrid,
+    Display::CursorCell,
+    Display::ColorRun,
     Keyboard::KeyboardController,
     CodeRunner::CodeRunController;
 
@@ -46,9 +55,18 @@ namespace Scene
             width{10}, height{15};
     };
 
+    // Content lines on page, as rows from content start: first one and page size.
+    // Opened document keeps only rows around page in ui, offset is row of first of them.
+    struct Viewport
+    {
+        size_t first{}, size{};
+        size_t offset{};
+    };
+
     struct Modal
     {
         std::vector<UiStringItem> ui{};
+        Viewport viewport{};
         std::string data{};
         std::function<void()> Ok{},
             Cancel{},
@@ -64,6 +82,14 @@ namespace Scene
         bool is_selected;
     };
 
+    struct RenderedContent
+    {
+        std::vector<UiStringItem> *ui{}; // nullptr when screen doesn't match
+        size_t first{}, count{};         // content row of first line on screen, lines on screen
+        size_t cursor_line{SIZE_MAX};    // content row cursor was drawn on
+        size_t cursor_column{};
+    };
+
     struct Clipboard
     {
         std::string data{};
@@ -79,18 +105,57 @@ namespace Scene
         uint8_t stage{};
 
         size_t stdin_entered{};
+        RenderedContent rendered{};
+        TextGrid grid;
+        bool cursor_shown{};
+
+        FontxFile *document_font{};
+        bool is_document_open{};
+
+        WrapIndex wrap{};
+        UndoJournal journal{CONFIG_UNDO_JOURNAL_SIZE};
+        SyntaxHighlighter syntax{};
+        std::vector<SyntaxRun> syntax_runs{};
+        TextFinder finder{};
+        Cursor find_cursor{}; // document cursor while find modal is open
+
+        size_t GetDocumentOffset(size_t row, size_t column);
+        void GetDocumentPosition(size_t offset, size_t &row, size_t &column);
+        void InsertDocumentRows(size_t row, size_t count);
+        void FitDocumentRows();
+        WrapChange UpdateDocumentRows(size_t offset, size_t removed, size_t inserted, size_t first_displayable);
+        void DocumentInsertChars(const std::string &chars, size_t scrolling, bool rerender);
+        void DocumentDeleteChars(size_t count, size_t scrolling);
+        void SpawnDocumentCursor(size_t offset, const WrapChange &change, size_t first_displayable, size_t scrolling, bool rerender);
+        void SpawnContentCursor(size_t row, size_t column, const WrapChange &change, size_t first_displayable, size_t scrolling, bool rerender);
+        void DocumentDeleteRange(size_t start, size_t end, size_t scrolling);
+        void DocumentReplaceRange(size_t start, size_t end, const char *chars, size_t count, size_t scrolling, bool rerender);
+        void SpliceLines(size_t row, size_t column, size_t end_row, size_t end_column,
+                         const std::string &chars, size_t scrolling, bool rerender);
+        bool IsHighlighting();
+        void GetRowColors(size_t row, std::vector<ColorRun> &colors);
 
     protected:
         static Clipboard clipboard;
         DisplayController &display;
         std::vector<UiStringItem> main_ui{};
         std::vector<UiStringItem> *ui{&main_ui};
+        Viewport main_viewport{};
+        Viewport *viewport{&main_viewport};
         std::map<uint8_t, Modal> modals{};
         const size_t default_line_length{37};
         const size_t max_lines_per_page{9};
+        const size_t document_rows_margin{max_lines_per_page}; // rows kept in ui above and below page
+        const size_t max_find_pattern_size{20};                // find input fits modal line
         size_t content_ui_start{0};
 
         bool is_code_running{};
+        TextBuffer text{};
+
+        void OpenDocument(FontxFile *font);
+        void CloseDocument();
+        bool IsDocumentEditing();
+        void SetDocumentLanguage(CodeLanguage language);
 
         void SetCursorControlling(bool cursor);
         virtual void EnterModalControlling();
@@ -98,6 +163,7 @@ namespace Scene
         void GetCursorXY(uint16_t *ret_x, uint16_t *ret_y, int16_t x = -1, int16_t y = -1);
         void GetSelectingXY(uint16_t &ret_sx, uint16_t &ret_sy, uint16_t &ret_ex, uint16_t &ret_ey,
                             uint8_t line_sx, uint8_t line_sy, uint8_t line_ex, uint8_t line_ey);
+        CursorCell GetCursorCell(UiStringItem *line, int16_t cursor_x, int16_t cursor_y);
         void ClearCursor(UiStringItem *line = nullptr, int16_t x = -1, int16_t y = -1);
         void UpdateSelecting(int8_t offset_y = 0);
         void SpawnCursor(int16_t cursor_x = -1, int16_t cursor_y = -1, bool clearing = true, bool rerender = true);
@@ -109,12 +175,15 @@ namespace Scene
         virtual bool IsCodeRunning();
         void CursorInit(FontxFile *font, uint8_t x = 0, uint8_t y = 0);
         void CursorDeleteChars(size_t count, size_t scrolling = 0);
-        void CursorInsertChars(std::string chars, size_t scrolling = 0, bool rerender = true);
+        void DeleteSelected();
+        void CursorInsertChars(const std::string &chars, size_t scrolling = 0, bool rerender = true);
         void CursorAppendLine(const char *label = "", Color color = Color::None);
         void CursorInsertLine(std::vector<UiStringItem>::iterator line_before, const char *label, Color color, bool displayable);
 
         virtual void InitModals();
         void InitCodeRunModal(uint8_t code_run_stage);
+        void InitFindModal(uint8_t find_stage, uint8_t home_stage);
+        void OpenFindModal(uint8_t find_stage, bool replacing);
 
         void AddModalLabel(std::string modal_label, Modal &modal);
 
@@ -181,6 +250,17 @@ namespace Scene
         virtual std::vector<UiStringItem>::iterator GetContentUiStart();
         size_t GetContentUiStartIndex();
         virtual size_t GetContentUiStartIndex(uint8_t stage);
+        size_t GetContentRows();
+        size_t GetContentRowLength(size_t row);
+        size_t GetLeadRows(int16_t *content_y = nullptr);
+        size_t GetDisplayedCount();
+        std::vector<UiStringItem>::iterator GetDisplayStart();
+        bool IsContentEndDisplayed();
+        void ShowViewport(bool show);
+        void SetViewport(size_t first);
+        void ResetViewport(size_t first = 0);
+        void SyncViewport();
+        void PositionViewport();
         std::vector<UiStringItem>::iterator GetFocused();
         std::vector<UiStringItem>::iterator GetFocused(std::vector<UiStringItem>::iterator begin);
         std::vector<UiStringItem>::iterator GetFocused(std::vector<UiStringItem>::iterator begin,
@@ -201,6 +281,9 @@ namespace Scene
         void RenderSelectedLines(uint8_t start_y, uint8_t end_y, uint8_t start_x, int8_t offset_y = 0);
 
         void RenderLines(uint8_t first_line, uint8_t last_line, bool clear_line_after = false, uint8_t start_x = 0);
+        bool SaveRenderedContent(bool drawn = true);
+        bool RenderContentShifted();
+        bool RenderGrid();
 
         virtual void ClearHeader(Color color = Color::None);
         virtual void ClearContent(Color color = Color::None);
@@ -213,6 +296,10 @@ namespace Scene
         virtual void Copy();
         virtual void Cut();
         virtual void Paste();
+        virtual bool Undo();
+        virtual bool Redo();
+        bool FindText(bool forward, bool rerender = true);
+        virtual size_t ReplaceAll(const std::string &replacement, bool rerender = true);
 
     public:
         Scene(DisplayController &display);
@@ -223,6 +310,7 @@ namespace Scene
         virtual void Delete();
         virtual void Value(char value);
         virtual void Tab();
+        void BlinkCursor();
 
         virtual void SendCodeOutput(const char *output);
         virtual void SendCodeError(const char *traceback);
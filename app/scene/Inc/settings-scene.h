@@ -9,6 +9,7 @@ namespace Scene
         void InitModals() override;
         void InitThemeSettingsModal();
         void InitFilesSortingSettingsModal();
+        void InitPixelFormatSettingsModal();
         void InitUI();
         void SetTheme(Settings::Themes theme);
 
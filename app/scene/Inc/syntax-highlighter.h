@@ -0,0 +1,53 @@
+#pragma once
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+#include "text-buffer.h"
+#include "wrap-index.h"
+#include "runner.h"
+
+using CodeRunner::CodeLanguage;
+
+namespace Scene
+{
+    enum class SyntaxToken : uint8_t
+    {
+        Text,
+        Keyword,
+        String,
+        Comment,
+        Number,
+    };
+
+    // Chars of row taken by one token kind
+    struct SyntaxRun
+    {
+        uint8_t length;
+        SyntaxToken token;
+    };
+
+    // Lua and Python tokenizer over wrapped document rows. Lexer state at start
+    // of every row (inside comment, short or long string) is cached, so a row
+    // is lexed alone. After an edit rows are lexed again from the edited one
+    // only until their state meets the cached one, and only as far as rows
+    // are asked for, so keystroke cost stays near the rows shown.
+    class SyntaxHighlighter
+    {
+        CodeLanguage language{CodeLanguage::Text};
+        std::vector<uint16_t> states{}; // state at row start
+        size_t lexed{};                 // states of rows before it are right
+
+        void lex(const TextBuffer &text, const WrapIndex &wrap, size_t end);
+        uint16_t lexRow(const TextBuffer &text, size_t start, size_t end, uint16_t state, std::vector<SyntaxRun> *runs) const;
+        bool isKeyword(const TextBuffer &text, size_t start, size_t end) const;
+
+    public:
+        void SetLanguage(CodeLanguage language);
+        bool IsEnabled() const;
+
+        void Build(size_t rows);
+        void Update(const WrapChange &change, size_t rows);
+        void GetRuns(const TextBuffer &text, const WrapIndex &wrap, size_t row, std::vector<SyntaxRun> &runs);
+    };
+}
@@ -0,0 +1,31 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <cstddef>
+
+namespace Scene
+{
+    // Editor text kept as gap buffer. Free space sits at the last edit place,
+    // so typing and deleting at cursor only moves the gap boundary.
+    class TextBuffer
+    {
+        std::vector<char> data{};
+        size_t gap_start{}, gap_end{};
+
+        void moveGap(size_t position);
+        void growGap(size_t count);
+
+    public:
+        size_t Size() const;
+        char At(size_t position) const;
+
+        void Assign(const char *text, size_t count);
+        void Append(const char *text, size_t count);
+        void Insert(size_t position, const char *text, size_t count);
+        void Erase(size_t position, size_t count);
+        void Clear();
+
+        void Copy(size_t position, size_t count, char *out) const;
+        std::string Substr(size_t position, size_t count) const;
+    };
+}
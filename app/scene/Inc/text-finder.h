@@ -0,0 +1,32 @@
+#pragma once
+#include <string>
+#include <cstddef>
+#include <cstdint>
+
+#include "text-buffer.h"
+
+namespace Scene
+{
+    // Boyer-Moore-Horspool search of a pattern in text buffer. Window is
+    // shifted by skip of its last char (first one searching backward), so
+    // most text chars are never read. Matches are returned as text buffer
+    // offsets, SIZE_MAX when there is none.
+    class TextFinder
+    {
+        std::string pattern{};
+        uint8_t skip[256]{};      // shift by last char of window
+        uint8_t back_skip[256]{}; // shift by first char of window
+
+        bool matches(const TextBuffer &text, size_t position) const;
+
+    public:
+        void SetPattern(const std::string &pattern);
+        const std::string &GetPattern() const;
+        bool IsEmpty() const;
+
+        size_t FindNext(const TextBuffer &text, size_t from) const;
+        size_t FindPrev(const TextBuffer &text, size_t end) const;
+        size_t ReplaceAll(const TextBuffer &text, const std::string &replacement,
+                          size_t &start, size_t &end, std::string &replaced) const;
+    };
+}
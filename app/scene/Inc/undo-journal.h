@@ -0,0 +1,54 @@
+#pragma once
+#include <deque>
+#include <vector>
+#include <cstddef>
+
+#include "text-buffer.h"
+
+namespace Scene
+{
+    // Edit to apply to text buffer: removed chars at offset are replaced by
+    // inserted ones from text
+    struct UndoStep
+    {
+        size_t offset;
+        size_t removed;
+        const char *text;
+        size_t inserted;
+    };
+
+    // Undo/redo history of text buffer edits. Each record keeps edit offset
+    // and its removed and inserted chars, text of records goes one after another
+    // into an arena. Single char edits next to last one are merged into it, so
+    // typed word is undone at once, until cursor moves or selection changes.
+    // Oldest records are dropped to fit budget.
+    class UndoJournal
+    {
+        struct Edit
+        {
+            size_t offset; // text buffer offset of edit
+            size_t text;   // arena position of removed chars, inserted ones follow
+            size_t removed, inserted;
+        };
+
+        std::deque<Edit> records{};
+        std::vector<char> arena{};
+        size_t arena_first{}; // arena position of first kept record text
+        size_t current{};     // records before it are done, rest can be redone
+        size_t budget{};
+        bool merging{};
+
+        size_t getUsed() const;
+        bool merge(const TextBuffer &text, size_t offset, const char *chars, size_t inserted);
+        void trim();
+
+    public:
+        UndoJournal(size_t budget);
+
+        void Record(const TextBuffer &text, size_t offset, size_t removed, const char *chars, size_t inserted);
+        bool Undo(UndoStep &step);
+        bool Redo(UndoStep &step);
+        void Break();
+        void Clear();
+    };
+}
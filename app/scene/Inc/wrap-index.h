@@ -0,0 +1,60 @@
+#pragma once
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+#include "text-buffer.h"
+
+namespace Scene
+{
+    // Rows replaced by WrapIndex::Update
+    struct WrapChange
+    {
+        size_t row;      // first changed row
+        size_t removed;  // rows there before edit
+        size_t inserted; // rows there after edit
+    };
+
+    // Visual rows of text wrapped at line length, a row ends after '\n' or
+    // when it is full. Last row is always open, so it may be empty.
+    // Row lengths are kept in chunks with Fenwick trees over chunk sums, so
+    // row <-> offset queries take O(log n) and an edit rewraps rows only
+    // from the edited one until row breaks line up with old ones again.
+    class WrapIndex
+    {
+        struct Chunk
+        {
+            std::vector<uint8_t> rows{};
+            size_t chars{};
+        };
+
+        struct Position
+        {
+            size_t chunk, index;
+        };
+
+        std::vector<Chunk> chunks{};
+        std::vector<size_t> rows_tree{}, chars_tree{}; // Fenwick trees of chunk rows and chars
+        size_t line_length{};
+        size_t rows_count{}, chars_count{};
+
+        void buildTrees();
+        void addTrees(size_t chunk, int64_t rows, int64_t chars);
+        size_t prefixRows(size_t chunk) const;
+        size_t prefixChars(size_t chunk) const;
+        Position findRow(size_t row) const;
+        Position findOffset(size_t offset, size_t *start) const;
+        uint8_t wrapRow(const TextBuffer &text, size_t offset) const;
+        void replaceRows(size_t row, size_t count, const std::vector<uint8_t> &rows);
+
+    public:
+        void Build(const TextBuffer &text, size_t line_length);
+        WrapChange Update(const TextBuffer &text, size_t offset, size_t removed, size_t inserted);
+
+        size_t GetRows() const;
+        size_t GetLineLength() const;
+        size_t GetRowStart(size_t row) const;
+        size_t GetRowLength(size_t row) const;
+        size_t GetRow(size_t offset) const;
+    };
+}
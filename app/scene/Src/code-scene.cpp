@@ -9,8 +9,15 @@ namespace Scene
     CodeScene::CodeScene(DisplayController &display)
         : Scene(display) {}
 
+    CodeScene::~CodeScene()
+    {
+        display.DisableFrameBuffer();
+    }
+
     void CodeScene::Init()
     {
+        // Editor and code log scroll by shifting lines in frame buffer
+        display.EnableFrameBuffer();
         content_ui_start = 3;
         InitModals();
 
@@ -26,7 +33,7 @@ namespace Scene
         ui->push_back(UiStringItem{"Run", theme.Colors.MainTextColor, display.fx24G});
         display.SetPosition(&*(ui->end() - 1), Position::End, Position::End);
 
-        ui->push_back(UiStringItem{"", theme.Colors.MainTextColor, display.fx16G, false});
+        OpenDocument(display.fx16G);
 
         CursorInit(display.fx16G);
         OpenStageModal(CodeSceneStage::LanguageChooseModalStage);
@@ -34,7 +41,9 @@ namespace Scene
 
     SceneId CodeScene::Escape()
     {
-        if (IsCursorControlling() && !IsStage(CodeSceneStage::CodeRunModalStage))
+        if (IsCursorControlling() &&
+            !IsStage(CodeSceneStage::CodeRunModalStage) &&
+            !IsStage(CodeSceneStage::FindModalStage))
         {
             SetCursorControlling(false);
             ChangeItemFocus(&*(ui->begin() + 1), true, true);
@@ -82,7 +91,18 @@ namespace Scene
 
             if (IsModalStage())
             {
-                if (IsStage(CodeSceneStage::LanguageChooseModalStage))
+                if (IsStage(CodeSceneStage::FindModalStage))
+                {
+                    if (focused->label.find("Ok") != std::string::npos)
+                    {
+                        GetStageModal().Ok();
+                    }
+                    else if (focused->label.find("Cancel") != std::string::npos)
+                    {
+                        GetStageModal().Cancel();
+                    }
+                }
+                else if (IsStage(CodeSceneStage::LanguageChooseModalStage))
                 {
 
                     for (auto &[key, language] : runner_languages)
@@ -90,6 +110,7 @@ namespace Scene
                         if (focused->label == key)
                         {
                             runner_language = language;
+                            SetDocumentLanguage(language);
                             ChangeHeader(key);
                             LeaveModalControlling();
                         }
@@ -134,6 +155,15 @@ namespace Scene
 
     void CodeScene::Value(char value)
     {
+        bool is_ctrl_pressed{KeyboardController::IsKeyPressed(Keyboard::Key::Ctrl)};
+
+        if (IsStage(CodeSceneStage::CodeEnterStage) && is_ctrl_pressed &&
+            (value == 'f' || value == 'F' || value == 'h' || value == 'H'))
+        {
+            OpenFindModal((uint8_t)CodeSceneStage::FindModalStage, value == 'h' || value == 'H');
+            return;
+        }
+
         Scene::Value(value);
     }
 
@@ -141,7 +171,7 @@ namespace Scene
     {
         Scene::RenderContent();
 
-        if (!(ui->end() - 1)->displayable)
+        if (!IsContentEndDisplayed())
         {
             RenderUiListEnding();
         }
@@ -160,7 +190,17 @@ namespace Scene
 
             if (rerender && count)
             {
-                RenderContent();
+                if (RenderContentShifted())
+                {
+                    if (!IsContentEndDisplayed())
+                    {
+                        RenderUiListEnding();
+                    }
+                }
+                else
+                {
+                    RenderContent();
+                }
             }
 
             return count;
@@ -173,6 +213,7 @@ namespace Scene
     {
         InitLanguageChooseModal();
         InitCodeRunModal((uint8_t)CodeSceneStage::CodeRunModalStage);
+        InitFindModal((uint8_t)CodeSceneStage::FindModalStage, (uint8_t)CodeSceneStage::CodeEnterStage);
     }
 
     void CodeScene::InitLanguageChooseModal()
@@ -184,7 +225,7 @@ namespace Scene
         display.SetPosition(&*(modal.ui.end() - 1), Position::Center, Position::End);
 
         uint8_t fw, fh;
-        Font::GetFontx(display.fx24G, 0, &fw, &fh);
+        Font::GetFontSize(display.fx24G, &fw, &fh);
 
         for (auto &[key, _] : runner_languages)
         {
@@ -239,6 +280,11 @@ namespace Scene
 
     size_t CodeScene::GetContentUiStartIndex(uint8_t stage)
     {
+        if (stage == (uint8_t)CodeSceneStage::FindModalStage)
+        {
+            return ui->end() - 1 - ui->begin();
+        }
+
         if (stage == (uint8_t)CodeSceneStage::LanguageChooseModalStage ||
             stage == (uint8_t)CodeSceneStage::CodeRunModalStage)
         {
@@ -250,9 +296,7 @@ namespace Scene
 
     void CodeScene::RunCode()
     {
-        std::string code{};
-        std::for_each(GetContentUiStart(), ui->end(), [&code](auto &item)
-                      { code += item.label; });
+        std::string code{text.Substr(0, text.Size())};
 
         OpenStageModal(CodeSceneStage::CodeRunModalStage);
 
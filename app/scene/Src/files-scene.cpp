@@ -9,6 +9,11 @@ namespace Scene
     FilesScene::FilesScene(DisplayController &display, SDCard &_sdcard)
         : Scene(display), sdcard{_sdcard} {}
 
+    FilesScene::~FilesScene()
+    {
+        display.DisableFrameBuffer();
+    }
+
     void FilesScene::Init()
     {
         content_ui_start = 4;
@@ -48,7 +53,7 @@ namespace Scene
     {
         Scene::RenderContent();
 
-        if (!(ui->end() - 1)->displayable)
+        if (!IsContentEndDisplayed())
         {
             RenderUiListEnding(IsStage(FilesSceneStage::FileOpenStage)
                                    ? "more lines"
@@ -73,6 +78,16 @@ namespace Scene
                 SaveFile();
                 enter = false;
             }
+            else if ((value == 'f' || value == 'F') && is_ctrl_pressed)
+            {
+                OpenFindModal((uint8_t)FilesSceneStage::FindModalStage, false);
+                enter = false;
+            }
+            else if ((value == 'h' || value == 'H') && is_ctrl_pressed)
+            {
+                OpenFindModal((uint8_t)FilesSceneStage::FindModalStage, true);
+                enter = false;
+            }
             else if (!is_ctrl_pressed && !(*ui)[3].label.size() && IsCursorControlling())
             {
                 ToggleSaveButton(true, true);
@@ -139,41 +154,29 @@ namespace Scene
             SortFiles();
         }
 
+        ResetViewport();
         return files.size();
     }
 
-    void FilesScene::ReadFile(std::string path)
+    // Read whole file to text buffer, false when it couldn't be read
+    // or is over CONFIG_MAX_OPEN_FILE_SIZE
+    bool FilesScene::ReadFile(std::string path)
     {
-        auto &theme{Settings::Settings::GetTheme()};
-        char buff[file_line_length + 1] = {0};
-        uint32_t seek_pos{0};
-        int read = 0;
-
-        while ((read = sdcard.ReadFile(
-                    path.c_str(),
-                    buff,
-                    file_line_length + 1,
-                    seek_pos)) != 0)
-        {
-            ui->push_back(UiStringItem{
-                buff,
-                theme.Colors.MainTextColor,
-                display.fx16G,
-                false,
-            });
-            seek_pos += read;
+        size_t size{};
+        if (sdcard.GetFileSize(path.c_str(), size) != ESP_OK)
+        {
+            return false;
         }
 
-        if (GetContentUiStart() == ui->end() ||
-            (ui->end() - 1)->label.size() == GetLineLength())
+        if (size > CONFIG_MAX_OPEN_FILE_SIZE)
         {
-            ui->push_back(UiStringItem{
-                "",
-                theme.Colors.MainTextColor,
-                display.fx16G,
-                false,
-            });
+            ESP_LOGE(TAG, "File %s is %zu bytes, over %d byte limit.", path.c_str(), size, CONFIG_MAX_OPEN_FILE_SIZE);
+            return false;
         }
+
+        text.Clear();
+        return sdcard.ReadFile(path.c_str(), [this](const char *buff, size_t read)
+                               { text.Append(buff, read); }) == ESP_OK;
     }
 
     void FilesScene::Arrow(Direction direction)
@@ -320,7 +323,8 @@ namespace Scene
                     }
                 }
             }
-            else if (stage == FilesSceneStage::CodeRunModalStage)
+            else if (stage == FilesSceneStage::CodeRunModalStage ||
+                     stage == FilesSceneStage::FindModalStage)
             {
                 LeaveModalControlling((uint8_t)FilesSceneStage::FileOpenStage);
             }
@@ -466,6 +470,14 @@ namespace Scene
 
     void FilesScene::OpenFile(const char *relative_path)
     {
+        // Empty document opened in place of unread file could be saved over it
+        if (!ReadFile(curr_directory + relative_path))
+        {
+            ESP_LOGE(TAG, "File %s is not opened.", relative_path);
+            text.Clear();
+            return;
+        }
+
         SaveDirectory();
         SetStage(FilesSceneStage::FileOpenStage);
         ChangeHeader(relative_path);
@@ -474,11 +486,14 @@ namespace Scene
         (*ui)[3].displayable = true;
         ui->erase(GetContentUiStart(), ui->end());
 
-        ReadFile(curr_directory + relative_path);
+        // Only rows around first page get ui items
+        OpenDocument(display.fx16G);
         DetectLanguage(relative_path);
+        // File lines scroll by shifting them in frame buffer
+        display.EnableFrameBuffer();
         RenderAll();
 
-        size_t lines_count = ui->size() - Scene::GetContentUiStartIndex();
+        size_t lines_count = GetContentRows();
 
         uint8_t cursor_x{static_cast<uint8_t>(file_line_length - 1)},
             cursor_y{static_cast<uint8_t>(lines_count > file_lines_per_page
@@ -489,15 +504,18 @@ namespace Scene
 
     void FilesScene::CloseFile()
     {
+        CloseDocument();
         ui->erase(GetContentUiStart(), ui->end());
         std::for_each(ui->begin(), ui->end(), [this](auto &item)
                       { if (item.focused) ChangeItemFocus(&item, false); });
 
         ui->insert(ui->end(), directory_backup.begin(), directory_backup.end());
+        main_viewport = directory_viewport;
         SetStage(FilesSceneStage::DirectoryStage);
         ChangeHeader("Files");
         (*ui)[3].displayable = false;
         ToggleCreateButton(true);
+        display.DisableFrameBuffer();
         RenderAll();
         directory_backup.clear();
     }
@@ -508,13 +526,15 @@ namespace Scene
             directory_backup.end(),
             ui->cbegin() + content_ui_start,
             ui->cend());
+        directory_viewport = main_viewport;
     }
 
     size_t FilesScene::GetContentUiStartIndex(uint8_t stg)
     {
         FilesSceneStage stage{stg};
         if (stage == FilesSceneStage::CreateModalStage ||
-            stage == FilesSceneStage::RenameModalStage)
+            stage == FilesSceneStage::RenameModalStage ||
+            stage == FilesSceneStage::FindModalStage)
         {
             return ui->end() - 1 - ui->begin();
         }
@@ -570,7 +590,7 @@ namespace Scene
                     ToggleUpButton(true);
                 }
                 else if (direction == Direction::Up &&
-                         (*ui)[content_ui_start + 1].displayable)
+                         viewport->first == 0)
                 {
                     ToggleUpButton(false);
                 }
@@ -578,7 +598,17 @@ namespace Scene
 
             if (rerender && count)
             {
-                RenderContent();
+                if (!is_directory_open_stage && RenderContentShifted())
+                {
+                    if (!IsContentEndDisplayed())
+                    {
+                        RenderUiListEnding("more lines");
+                    }
+                }
+                else
+                {
+                    RenderContent();
+                }
             }
 
             return count;
@@ -595,14 +625,10 @@ namespace Scene
         }
 
         std::string file_path{curr_directory + (*ui)[0].label};
-        uint64_t pos{0};
-        auto line{GetContentUiStart()};
-
-        while (line != ui->end() && sdcard.WriteFile(file_path.c_str(), line->label.c_str(), pos) == ESP_OK)
+        if (sdcard.WriteFile(file_path.c_str(), text.Substr(0, text.Size()).c_str()) != ESP_OK)
         {
-            pos += line->label.size();
-            ESP_LOGV(TAG, "Writing \"%s\", pos %lld", line->label.c_str(), pos);
-            line++;
+            ESP_LOGE(TAG, "File %s is not saved.", file_path.c_str());
+            return;
         }
 
         ToggleSaveButton(false, true);
@@ -615,6 +641,7 @@ namespace Scene
         InitCreateChooseModal();
         InitCreateModal();
         InitRenameModal();
+        InitFindModal((uint8_t)FilesSceneStage::FindModalStage, (uint8_t)FilesSceneStage::FileOpenStage);
 
         for (auto &[key, modal] : modals)
         {
@@ -674,7 +701,7 @@ namespace Scene
         display.SetPosition(&*(modal.ui.end() - 1), Position::Center, Position::Center);
 
         uint8_t fw, fh;
-        Font::GetFontx(display.fx24G, 0, &fw, &fh);
+        Font::GetFontSize(display.fx24G, &fw, &fh);
 
         modal.ui.push_back(UiStringItem{"Directory", theme.Colors.MainTextColor, display.fx24G});
         (modal.ui.end() - 1)->y = (modal.ui.end() - 2)->y - fh;
@@ -894,13 +921,12 @@ namespace Scene
             ChangeItemFocus(&(*(file_item - 1)), true);
         }
 
-        auto next_displaying = std::find_if(
-            file_item,
-            main_ui.end(),
-            [](auto &item)
-            { return !item.displayable; });
+        // Row below page moves up into it
+        auto next_displaying{main_ui.begin() +
+                             GetContentUiStartIndex((uint8_t)FilesSceneStage::DirectoryStage) +
+                             main_viewport.first + main_viewport.size};
 
-        if (next_displaying != main_ui.end())
+        if (next_displaying < main_ui.end())
         {
             next_displaying->displayable = true;
         }
@@ -936,23 +962,13 @@ namespace Scene
         std::transform(filename.begin(), filename.end(), filename.begin(), toupper);
         UiStringItem new_line{filename, Settings::Settings::GetTheme().Colors.MainTextColor, display.fx16G};
 
-        size_t displayable_count{static_cast<size_t>(
-            std::count_if(
-                main_ui.begin() + GetContentUiStartIndex((uint8_t)FilesSceneStage::DirectoryStage),
-                main_ui.end(),
-                [](auto &item)
-                { return item.displayable; }))};
-
-        if (displayable_count == GetLinesPerPageCount((uint8_t)FilesSceneStage::DirectoryStage) - 1)
-        {
-            new_line.displayable = false;
-        }
-
         if ((main_ui.end() - 1)->displayable && !(main_ui.end() - 1)->focusable)
         {
             main_ui.erase(main_ui.end() - 1, main_ui.end());
         }
 
+        size_t row{main_ui.size() - GetContentUiStartIndex((uint8_t)FilesSceneStage::DirectoryStage)};
+        new_line.displayable = row < main_viewport.first + main_viewport.size;
         main_ui.push_back(new_line);
 
         return true;
@@ -1000,6 +1016,8 @@ namespace Scene
             runner_language = CodeLanguage::Text;
         }
 
+        SetDocumentLanguage(runner_language);
+
         const char *arr[]{"Text", "Lua", "Python" /*, "Ruby" */};
         ESP_LOGD(TAG, "Detected language: %s", arr[(int)runner_language]);
     }
@@ -1299,6 +1317,39 @@ namespace Scene
         }
     }
 
+    bool FilesScene::Undo()
+    {
+        bool is_undone{Scene::Undo()};
+        if (is_undone)
+        {
+            ToggleSaveButton(true, true);
+        }
+
+        return is_undone;
+    }
+
+    bool FilesScene::Redo()
+    {
+        bool is_redone{Scene::Redo()};
+        if (is_redone)
+        {
+            ToggleSaveButton(true, true);
+        }
+
+        return is_redone;
+    }
+
+    size_t FilesScene::ReplaceAll(const std::string &replacement, bool rerender)
+    {
+        size_t count{Scene::ReplaceAll(replacement, rerender)};
+        if (count)
+        {
+            ToggleSaveButton(true, rerender);
+        }
+
+        return count;
+    }
+
     void FilesScene::PasteFile()
     {
         std::string filename{};
@@ -1338,10 +1389,10 @@ namespace Scene
         }
 
         UiStringItem item{filename, Settings::Settings::GetTheme().Colors.MainTextColor, display.fx16G};
-        item.displayable = (ui->end() - 1)->displayable;
+        item.displayable = GetContentRows() < viewport->first + viewport->size;
         ui->push_back(item);
 
-        if ((ui->end() - 1)->displayable)
+        if (item.displayable)
         {
             RenderContent();
         }
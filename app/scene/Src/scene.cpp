@@ -22,7 +22,7 @@ namespace Scene
         false,
         false};
 
-    Scene::Scene(DisplayController &_display) : display{_display} {}
+    Scene::Scene(DisplayController &_display) : grid{_display}, display{_display} {}
 
     void Scene::Value(char value)
     {
@@ -70,6 +70,22 @@ namespace Scene
             {
                 SelectAll();
             }
+            else if (value == 'z' || value == 'Z')
+            {
+                Undo();
+            }
+            else if (value == 'y' || value == 'Y')
+            {
+                Redo();
+            }
+            else if (value == 'n' || value == 'N')
+            {
+                FindText(true);
+            }
+            else if (value == 'p' || value == 'P')
+            {
+                FindText(false);
+            }
         }
     }
 
@@ -109,7 +125,7 @@ namespace Scene
             fe_cb = [&new_focused, &last_focused, &add_cond](auto &item)
             {
                 uint8_t fw;
-                Font::GetFontx(last_focused->font, 0, &fw, 0);
+                Font::GetFontSize(last_focused->font, &fw, 0);
                 bool main_cond{item.x > (last_focused->x + last_focused->label.size() * fw) &&
                                item.focusable &&
                                item.displayable};
@@ -245,26 +261,13 @@ namespace Scene
                  KeyboardController::IsKeyPressed(Keyboard::Key::Ctrl)) ||
                 selected.is_selected)
             {
-                auto ui_start{GetContentUiStart()};
-                auto first_displayable{std::find_if(
-                    ui_start,
-                    ui->end(),
-                    [](auto &item)
-                    { return item.displayable; })};
-
-                auto last_displayable{std::find_if(
-                                          first_displayable,
-                                          ui->end(),
-                                          [](auto &item)
-                                          { return !item.displayable; }) -
-                                      1};
-
-                bool scroll_up{first_displayable != ui->end() &&
-                               first_displayable != ui_start &&
+                bool displayed{GetDisplayedCount() > 0};
+                bool scroll_up{displayed &&
+                               viewport->first != 0 &&
                                cursor.y == 0 &&
                                direction == Direction::Up};
-                bool scroll_down{last_displayable != ui->end() &&
-                                 last_displayable != ui->end() - 1 && cursor.y == GetLinesPerPageCount() - 1 &&
+                bool scroll_down{displayed &&
+                                 !IsContentEndDisplayed() && cursor.y == GetLinesPerPageCount() - 1 &&
                                  direction == Direction::Bottom};
 
                 bool scroll{scroll_up || scroll_down};
@@ -302,18 +305,12 @@ namespace Scene
 
     void Scene::RenderUiListEnding(const char *end_label)
     {
-        auto last_displayable{
-            std::find_if(ui->rbegin(),
-                         ui->rend() - GetContentUiStartIndex(),
-                         [](auto &item)
-                         { return item.displayable; })
-                .base() -
-            1};
-
-        if (last_displayable != ui->end())
+        size_t count{GetDisplayedCount()};
+        if (count)
         {
-            display.DrawListEndingLabel(last_displayable,
-                                        ui->end() - last_displayable - 1,
+            // Opened document keeps only some rows in ui, count rest of content rows
+            display.DrawListEndingLabel(GetDisplayStart() + count - 1,
+                                        GetContentRows() - (viewport->first + count),
                                         end_label);
         }
     }
@@ -340,6 +337,10 @@ namespace Scene
                 stdin_entered--;
             }
         }
+        else if (IsCursorControlling() && selected.is_selected)
+        {
+            DeleteSelected();
+        }
         else if (IsCursorControlling())
         {
             CursorDeleteChars(1, GetLinesScroll());
@@ -375,6 +376,138 @@ namespace Scene
         return GetLinesPerPageCount(stage);
     }
 
+    // Opened document has rows not kept in ui, they are counted by wrap index
+    size_t Scene::GetContentRows()
+    {
+        if (IsDocumentEditing())
+        {
+            return wrap.GetRows();
+        }
+
+        size_t start{GetContentUiStartIndex()};
+        return ui->size() > start ? ui->size() - start : 0;
+    }
+
+    size_t Scene::GetContentRowLength(size_t row)
+    {
+        if (IsDocumentEditing())
+        {
+            return wrap.GetRowLength(row);
+        }
+
+        return (*ui)[GetContentUiStartIndex() + row].label.length();
+    }
+
+    // Main ui items drawn on page before content lines, like Up button
+    // content_y gets where content lines start then.
+    size_t Scene::GetLeadRows(int16_t *content_y)
+    {
+        size_t rows{};
+        int16_t y = display.GetHeight() - 60;
+
+        if (ui == &main_ui)
+        {
+            uint8_t fh;
+            for (auto it{ui->begin() + content_ui_start}; it < GetContentUiStart(); it++)
+            {
+                if (!it->displayable)
+                    continue;
+
+                Font::GetFontSize(it->font, 0, &fh);
+                y -= fh;
+                rows++;
+            }
+        }
+
+        if (content_y)
+        {
+            *content_y = y;
+        }
+
+        return rows;
+    }
+
+    size_t Scene::GetDisplayedCount()
+    {
+        size_t rows{GetContentRows()};
+        return viewport->first < rows ? std::min(viewport->size, rows - viewport->first) : 0;
+    }
+
+    std::vector<UiStringItem>::iterator Scene::GetDisplayStart()
+    {
+        return viewport->first < GetContentRows() ? GetContentUiStart() + (viewport->first - viewport->offset) : ui->end();
+    }
+
+    bool Scene::IsContentEndDisplayed()
+    {
+        return viewport->first + viewport->size >= GetContentRows();
+    }
+
+    // Set flags of page rows kept in ui, page may be partly out of them during edits
+    void Scene::ShowViewport(bool show)
+    {
+        auto start{GetContentUiStart()};
+        size_t kept_end{viewport->offset + (ui->end() - start)};
+        size_t first{std::max(viewport->first, viewport->offset)};
+        size_t end{std::min(viewport->first + GetDisplayedCount(), kept_end)};
+
+        for (size_t row{first}; row < end; row++)
+        {
+            (start + (row - viewport->offset))->displayable = show;
+        }
+    }
+
+    // Scroll page to first row, only rows leaving and entering it are touched
+    void Scene::SetViewport(size_t first)
+    {
+        size_t rows{GetContentRows()};
+
+        ShowViewport(false);
+        viewport->first = rows ? std::min(first, rows - 1) : 0;
+        FitDocumentRows();
+        ShowViewport(true);
+    }
+
+    // Page for content built again, all its rows get displayable flags
+    void Scene::ResetViewport(size_t first)
+    {
+        size_t rows{GetContentRows()};
+        size_t lines_per_page{GetLinesPerPageCount()};
+        size_t lead{GetLeadRows()};
+
+        viewport->size = lines_per_page > lead ? lines_per_page - lead : 0;
+        viewport->first = rows ? std::min(first, rows - 1) : 0;
+
+        size_t row{viewport->offset};
+        for (auto it{GetContentUiStart()}; it < ui->end(); it++, row++)
+        {
+            it->displayable = row >= viewport->first && row < viewport->first + viewport->size;
+        }
+    }
+
+    // Take page from displayable flags, as modals set them up
+    void Scene::SyncViewport()
+    {
+        size_t lines_per_page{GetLinesPerPageCount()};
+        size_t lead{GetLeadRows()};
+        size_t rows{GetContentRows()};
+        auto start{GetContentUiStart()};
+
+        viewport->size = lines_per_page > lead ? lines_per_page - lead : 0;
+        viewport->first = 0;
+        while (viewport->first < rows && !(start + viewport->first)->displayable)
+        {
+            viewport->first++;
+        }
+    }
+
+    void Scene::PositionViewport()
+    {
+        size_t count{GetDisplayedCount()};
+        auto start{GetDisplayStart()};
+        display.SetListPositions(start, start + count, 10, display.GetHeight() - 60, count);
+    }
+
     void Scene::RenderAll()
     {
         RenderHeader();
@@ -399,11 +532,36 @@ namespace Scene
     {
         ClearContent(Settings::Settings::GetTheme().Colors.MainBackgroundColor);
 
-        display.DrawStringItems(ui->begin() + content_ui_start,
-                                ui->end(),
-                                10,
-                                display.GetHeight() - 60,
-                                GetLinesPerPageCount());
+        int16_t content_y;
+        size_t lead{GetLeadRows(&content_y)};
+        if (lead)
+        {
+            display.DrawStringItems(ui->begin() + content_ui_start,
+                                    GetContentUiStart(),
+                                    10,
+                                    display.GetHeight() - 60,
+                                    lead);
+        }
+
+        // Highlighted page is drawn once, by grid in syntax colors
+        bool highlighting{IsHighlighting() && !selected.is_selected};
+        if (!highlighting)
+        {
+            display.DrawStringItems(GetDisplayStart(),
+                                    GetDisplayStart() + GetDisplayedCount(),
+                                    10,
+                                    content_y,
+                                    GetDisplayedCount());
+        }
+
+        if (!SaveRenderedContent(!highlighting) && highlighting)
+        {
+            display.DrawStringItems(GetDisplayStart(),
+                                    GetDisplayStart() + GetDisplayedCount(),
+                                    10,
+                                    content_y,
+                                    GetDisplayedCount());
+        }
 
         if (selected.is_selected)
         {
@@ -411,17 +569,229 @@ namespace Scene
         }
     }
 
+    // Remember which lines are on screen, so scrolling and editing can reuse them.
+    // Lines not drawn yet are drawn by grid, false when grid can't be used.
+    bool Scene::SaveRenderedContent(bool drawn)
+    {
+        auto first_displayable{GetDisplayStart()};
+
+        rendered.ui = ui;
+        rendered.first = viewport->first;
+        rendered.count = GetDisplayedCount();
+
+        grid.Invalidate();
+        if (selected.is_selected || first_displayable == ui->end())
+            return false;
+
+        auto &theme{Settings::Settings::GetTheme()};
+
+        // Row after the last line is for list ending label
+        grid.Reset(first_displayable->font,
+                   first_displayable->x,
+                   first_displayable->y,
+                   GetLinesPerPageCount() + 1,
+                   theme.Colors.MainBackgroundColor);
+
+        uint8_t row{0};
+        for (auto it = first_displayable; row < rendered.count; it++, row++)
+        {
+            if (it->font != first_displayable->font)
+            {
+                grid.Invalidate();
+                return false;
+            }
+
+            grid.SyncRow(row, drawn ? it->label : "", it->color,
+                         it->backgroundColor == Color::None ? theme.Colors.MainBackgroundColor : it->backgroundColor);
+        }
+
+        if (!IsContentEndDisplayed())
+        {
+            grid.Invalidate(row);
+        }
+
+        // Grid draws syntax colored cells over lines drawn in one color,
+        // and whole lines that weren't drawn
+        if (IsHighlighting() || !drawn)
+        {
+            return RenderGrid();
+        }
+
+        return true;
+    }
+
+    bool Scene::IsHighlighting()
+    {
+        return IsDocumentEditing() && syntax.IsEnabled();
+    }
+
+    // Colors of content row chars from syntax tokens, rows above it are lexed when needed
+    void Scene::GetRowColors(size_t row, std::vector<ColorRun> &colors)
+    {
+        auto &theme{Settings::Settings::GetTheme()};
+        syntax.GetRuns(text, wrap, row, syntax_runs);
+
+        colors.clear();
+        for (const SyntaxRun &run : syntax_runs)
+        {
+            Color color{theme.Colors.MainTextColor};
+            switch (run.token)
+            {
+            case SyntaxToken::Keyword:
+                color = theme.Colors.KeywordColor;
+                break;
+            case SyntaxToken::String:
+                color = theme.Colors.StringColor;
+                break;
+            case SyntaxToken::Comment:
+                color = theme.Colors.CommentColor;
+                break;
+            case SyntaxToken::Number:
+                color = theme.Colors.NumberColor;
+                break;
+            default:
+                break;
+            }
+
+            colors.push_back(ColorRun{run.length, color});
+        }
+
+        if (colors.empty())
+        {
+            colors.push_back(ColorRun{UINT8_MAX, theme.Colors.MainTextColor});
+        }
+    }
+
+    // Draw content lines through text grid, only cells changed since last
+    // render are drawn. List ending label is left for caller.
+    // Returns false when grid doesn't match screen, content has to be rendered whole.
+    bool Scene::RenderGrid()
+    {
+        if (rendered.ui != ui || selected.is_selected)
+            return false;
+
+        auto first_displayable{GetDisplayStart()};
+
+        if (first_displayable == ui->end() ||
+            !grid.IsValid(first_displayable->font, first_displayable->x, first_displayable->y))
+        {
+            return false;
+        }
+
+        auto &theme{Settings::Settings::GetTheme()};
+        bool list_ending{!IsContentEndDisplayed()};
+        size_t count{GetDisplayedCount()};
+        uint8_t row{0};
+
+        bool highlighting{IsHighlighting()};
+        std::vector<ColorRun> colors{};
+
+        for (auto it = first_displayable; row < count && row < grid.GetRows(); it++, row++)
+        {
+            Color background{it->backgroundColor == Color::None ? theme.Colors.MainBackgroundColor : it->backgroundColor};
+            if (highlighting)
+            {
+                GetRowColors(viewport->first + row, colors);
+                grid.SetRow(row, it->label, colors.data(), colors.size(), background);
+            }
+            else
+            {
+                grid.SetRow(row, it->label, it->color, background);
+            }
+        }
+
+        rendered.first = viewport->first;
+        rendered.count = row;
+
+        for (; row < grid.GetRows(); row++)
+        {
+            if (list_ending)
+            {
+                grid.Invalidate(row);
+                list_ending = false;
+                continue;
+            }
+
+            grid.SetRow(row, "", theme.Colors.MainTextColor, theme.Colors.MainBackgroundColor);
+        }
+
+        return true;
+    }
+
+    // Draw content after scrolling by shifting lines already on screen,
+    // text grid then draws only lines moved in and changed cells.
+    // Returns false when content has to be rendered whole.
+    bool Scene::RenderContentShifted()
+    {
+        if (rendered.ui != ui || selected.is_selected)
+            return false;
+
+        auto first_displayable{GetDisplayStart()};
+
+        if (first_displayable == ui->end())
+            return false;
+
+        size_t lines_per_page{GetLinesPerPageCount()};
+        size_t first{viewport->first};
+        size_t count{GetDisplayedCount()};
+        int scrolled{static_cast<int>(first) - static_cast<int>(rendered.first)};
+
+        if (count < rendered.count || count > lines_per_page || std::abs(scrolled) >= static_cast<int>(count))
+            return false;
+
+        uint8_t fh;
+        Font::GetFontSize(first_displayable->font, 0, &fh);
+        const int16_t lines_start_y = display.GetHeight() - 60;
+
+        PositionViewport();
+
+        if (!grid.IsValid(first_displayable->font, first_displayable->x, first_displayable->y))
+            return false;
+
+        // Line r covers y from lines_start_y - r * fh + 1 to lines_start_y - (r - 1) * fh
+        if (scrolled != 0)
+        {
+            if (!display.ScrollArea(0, lines_start_y - (count - 1) * fh + 1,
+                                    display.GetWidth(), lines_start_y + fh,
+                                    scrolled * fh))
+            {
+                return false;
+            }
+
+            grid.Scroll(scrolled, count);
+        }
+
+        // Cursor drawn before scrolling moved with lines, it reaches row above too
+        if (rendered.cursor_line >= first && rendered.cursor_line < first + count)
+        {
+            uint8_t cursor_row = rendered.cursor_line - first;
+            grid.Invalidate(cursor_row, rendered.cursor_column, 1);
+            if (cursor_row > 0)
+            {
+                grid.Invalidate(cursor_row - 1, rendered.cursor_column, 1);
+            }
+        }
+
+        return RenderGrid();
+    }
+
     void Scene::RenderLines(uint8_t first_line, uint8_t last_line, bool clear_line_after, uint8_t start_x)
     {
         ESP_LOGD(TAG, "Render lines");
+
+        if (RenderGrid())
+        {
+            if (!IsContentEndDisplayed())
+            {
+                RenderUiListEnding("more lines");
+            }
+            return;
+        }
+
         auto &theme{Settings::Settings::GetTheme()};
         uint8_t fw, fh;
         size_t lines_per_page{GetLinesPerPageCount()};
-        auto first_displaying = std::find_if(
-            GetContentUiStart(),
-            ui->end(),
-            [](auto &item)
-            { return item.displayable; });
+        auto first_displaying{GetDisplayStart()};
 
         if (first_displaying == ui->end())
         {
@@ -430,7 +800,7 @@ namespace Scene
         }
 
         size_t first_displaying_index{static_cast<size_t>(first_displaying - ui->begin())};
-        Font::GetFontx(first_displaying->font, 0, &fw, &fh);
+        Font::GetFontSize(first_displaying->font, &fw, &fh);
 
         uint16_t lines_start_x{first_displaying->x},
             lines_start_y(first_displaying->y - first_line * fh),
@@ -460,7 +830,7 @@ namespace Scene
 
             UiStringItem item{(*ui)[first_displaying_index + first_line]};
 
-            item.label.erase(item.label.begin(), item.label.begin() + start_x);
+            item.label.erase(item.label.begin(), item.label.begin() + std::min<size_t>(start_x, item.label.size()));
             item.x += start_x * fw;
 
             display.DrawStringItem(&item);
@@ -485,16 +855,17 @@ namespace Scene
 
         auto first_render_line{first_displaying + first_line};
         auto render_end{first_displaying + last_line + 1};
-        if (render_end > ui->end())
+        if (render_end > first_displaying + GetDisplayedCount())
         {
-            render_end = ui->end();
+            render_end = first_displaying + GetDisplayedCount();
         }
 
         display.DrawStringItems(first_render_line, render_end,
                                 lines_start_x, lines_start_y,
                                 lines_per_page - first_line);
+        SaveRenderedContent();
 
-        if (!(ui->end() - 1)->displayable)
+        if (!IsContentEndDisplayed())
         {
             RenderUiListEnding("more lines");
         }
@@ -517,20 +888,10 @@ namespace Scene
         *ret_y = static_cast<uint16_t>(first_line->y - y * cursor.height + 2);
     }
 
-    void Scene::ClearCursor(UiStringItem *line,
-                            int16_t cursor_x,
-                            int16_t cursor_y)
+    // Character under the cursor cell, as ClearCursor draws it back
+    CursorCell Scene::GetCursorCell(UiStringItem *line, int16_t cursor_x, int16_t cursor_y)
     {
-        if (cursor_x < 0)
-        {
-            cursor_x = cursor.x;
-        }
-        if (cursor_y < 0)
-        {
-            cursor_y = cursor.y;
-        }
-
-        ESP_LOGD(TAG, "Clear cursor: x %d, y %d", cursor_x, cursor_y);
+        size_t cx{static_cast<size_t>(cursor_x)};
 
         uint16_t x, y;
         GetCursorXY(&x, &y, cursor_x, cursor_y);
@@ -540,24 +901,17 @@ namespace Scene
 
         if (selected.is_selected)
         {
-            size_t first_displaying_index{
-                static_cast<size_t>(std::find_if(
-                                        GetContentUiStart(),
-                                        ui->end(),
-                                        [](auto &item)
-                                        { return item.displayable; }) -
-                                    GetContentUiStart())};
-            size_t cy{cursor_y + first_displaying_index};
+            size_t cy{cursor_y + viewport->first};
 
             bool is_cursor_selected{
                 (cy > selected.start_y && cy < selected.end_y) ||
                 (cy == selected.start_y &&
-                 ((cursor_x >= selected.start_x && (cursor_x < selected.end_x || cy < selected.end_y)) ||
-                  (cursor_x >= selected.start_x &&
+                 ((cx >= selected.start_x && (cx < selected.end_x || cy < selected.end_y)) ||
+                  (cx >= selected.start_x &&
                    selected.start_x == selected.end_x))) ||
                 (cy == selected.end_y &&
-                 (cursor_x >= selected.start_x || cy > selected.start_y) &&
-                 cursor_x < selected.end_x)};
+                 (cx >= selected.start_x || cy > selected.start_y) &&
+                 cx < selected.end_x)};
 
             if (is_cursor_selected)
             {
@@ -565,23 +919,75 @@ namespace Scene
             }
         }
 
-        display.Clear(clear_color, x, y, x + cursor.width, y + cursor.height);
-        y -= 2;
-
-        if (line != nullptr)
+        char sym = ' ';
+        Color color{line != nullptr ? line->color : Color::None};
+        if (line != nullptr && cx < line->label.size())
         {
-            char sym = ' ';
-            if (cursor_x < line->label.size())
+            sym = line->label[cx];
+
+            // Selected lines are drawn in one color
+            if (IsHighlighting() && !selected.is_selected)
             {
-                sym = line->label[cursor_x];
+                std::vector<ColorRun> colors{};
+                GetRowColors(viewport->first + cursor_y, colors);
+
+                size_t column{cx};
+                for (const ColorRun &run : colors)
+                {
+                    color = run.color;
+                    if (column < run.length)
+                        break;
+                    column -= run.length;
+                }
             }
+        }
+
+        return CursorCell{
+            line != nullptr ? line->font : nullptr,
+            sym,
+            color,
+            clear_color,
+            x,
+            static_cast<uint16_t>(y - 2)};
+    }
+
+    void Scene::ClearCursor(UiStringItem *line,
+                            int16_t cursor_x,
+                            int16_t cursor_y)
+    {
+        if (cursor_x < 0)
+        {
+            cursor_x = cursor.x;
+        }
+        if (cursor_y < 0)
+        {
+            cursor_y = cursor.y;
+        }
+
+        ESP_LOGD(TAG, "Clear cursor: x %d, y %d", cursor_x, cursor_y);
+
+        uint16_t x, y;
+        GetCursorXY(&x, &y, cursor_x, cursor_y);
+        CursorCell cell{GetCursorCell(line, cursor_x, cursor_y)};
+        cursor_shown = false;
+
+        // Saved tile puts the cell back without redrawing its character
+        if (line != nullptr && display.ClearCursor(x, y, cell))
+        {
+            return;
+        }
+
+        display.Clear(cell.background, x, y, x + cursor.width, y + cursor.height);
+
+        if (line != nullptr)
+        {
             UiStringItem previous_cursor_pos{
-                std::string(1, sym).c_str(),
-                line->color,
-                line->font,
+                std::string(1, cell.c).c_str(),
+                cell.color,
+                cell.font,
                 false,
                 Color::None,
-                x, y};
+                cell.x, cell.y};
 
             display.DrawStringItem(&previous_cursor_pos);
         }
@@ -592,14 +998,35 @@ namespace Scene
         if (!IsCursorControlling())
             return;
 
+        auto first_displayable{GetDisplayStart()};
+
+        rendered.cursor_line = viewport->first + cursor.y;
+        rendered.cursor_column = cursor.x;
+
         uint16_t cursor_x{}, cursor_y{};
         GetCursorXY(&cursor_x, &cursor_y);
 
+        UiStringItem *line{first_displayable + cursor.y < ui->end() ? &*(first_displayable + cursor.y) : nullptr};
+
         display.DrawCursor(
             cursor_x,
             cursor_y,
             cursor.width,
-            cursor.height);
+            cursor.height,
+            GetCursorCell(line, cursor.x, cursor.y));
+        cursor_shown = true;
+    }
+
+    // Blink cursor over its saved tile, cursor is drawn again when something covered it
+    void Scene::BlinkCursor()
+    {
+        if (!cursor_shown || !IsCursorControlling())
+            return;
+
+        if (!display.BlinkCursor())
+        {
+            RenderCursor();
+        }
     }
 
     void Scene::SpawnCursor(int16_t cursor_x, int16_t cursor_y, bool clearing, bool rerender)
@@ -614,11 +1041,7 @@ namespace Scene
             cursor_y = cursor.y;
         }
 
-        size_t displayable_count{static_cast<size_t>(std::count_if(
-            GetContentUiStart(),
-            ui->end(),
-            [](auto &item)
-            { return item.displayable; }))};
+        size_t displayable_count{GetDisplayedCount()};
 
         if (cursor_y > displayable_count - 1)
         {
@@ -626,11 +1049,7 @@ namespace Scene
             cursor_x = GetLineLength();
         }
 
-        auto first_displayable{std::find_if(
-            GetContentUiStart(),
-            ui->end(),
-            [](auto &item)
-            { return item.displayable; })};
+        auto first_displayable{GetDisplayStart()};
 
         auto line{first_displayable};
 
@@ -652,7 +1071,7 @@ namespace Scene
         }
 
         if (line == ui->end() - 1 && cursor_x == line->label.size() &&
-            line->label[line->label.size() - 1] == '\n')
+            !line->label.empty() && line->label.back() == '\n')
         {
             CursorAppendLine();
             cursor_x = 0;
@@ -683,8 +1102,8 @@ namespace Scene
         if (!IsCursorControlling())
             return 0;
 
-        auto line = std::find_if(GetContentUiStart(), ui->end(), [](auto &item)
-                                 { return item.displayable; });
+        journal.Break();
+        auto line{GetDisplayStart()};
 
         if (line == ui->end())
             return 0;
@@ -736,12 +1155,7 @@ namespace Scene
                 {
                     scrolled_count = ScrollContent(Direction::Bottom, rerender, scrolling);
                     if (scrolled_count)
-                        cursor_y = std::count_if(
-                                       GetContentUiStart(),
-                                       ui->end(),
-                                       [](auto &item)
-                                       { return item.displayable; }) -
-                                   scrolled_count;
+                        cursor_y = GetDisplayedCount() - scrolled_count;
                 }
                 cursor_x = 0;
             }
@@ -762,12 +1176,7 @@ namespace Scene
                     scrolled_count = ScrollContent(Direction::Bottom, rerender, scrolling);
                     if (scrolled_count)
                     {
-                        cursor_y = std::count_if(
-                                       GetContentUiStart(),
-                                       ui->end(),
-                                       [](auto &item)
-                                       { return item.displayable; }) -
-                                   scrolled_count;
+                        cursor_y = GetDisplayedCount() - scrolled_count;
                     }
                 }
                 else
@@ -811,351 +1220,459 @@ namespace Scene
         return scrolled_count;
     }
 
+    // Move page by count rows, page stays full while there are rows for it
     uint8_t Scene::ScrollContent(Direction direction, bool rerender, uint8_t count)
     {
-        size_t lines_per_page{GetLinesPerPageCount()};
+        size_t displayed{GetDisplayedCount()};
+        size_t rows{GetContentRows()};
+        size_t first{viewport->first};
+
+        if (!displayed)
+            return 0;
 
         if (direction == Direction::Bottom)
         {
-            auto first_displayable = std::find_if(
-                GetContentUiStart(),
-                ui->end(),
-                [](auto &item)
-                { return item.displayable; });
+            if (first + displayed >= rows)
+                return 0;
 
-            auto last_displayable = std::find_if(
-                                        ui->rbegin(),
-                                        ui->rend() - GetContentUiStartIndex(),
-                                        [](auto &item)
-                                        { return item.displayable; })
-                                        .base() -
-                                    1;
+            count = std::min<size_t>(count, rows - first - displayed);
+            SetViewport(first + count);
+            return count;
+        }
 
-            if (last_displayable >= ui->end() - 1 || first_displayable == ui->end())
-            {
+        if (direction == Direction::Up)
+        {
+            if (first == 0)
                 return 0;
-            }
 
-            if (count > ui->end() - last_displayable - 1)
-            {
-                count = ui->end() - last_displayable - 1;
-            }
+            count = std::min<size_t>(count, first);
+            SetViewport(first - count);
+            return count;
+        }
 
-            std::vector<UiStringItem>::iterator it{};
-            for (it = GetContentUiStart();
-                 it < last_displayable &&
-                 it < first_displayable + count;
-                 it++)
-            {
-                it->displayable = false;
-            }
+        return 0;
+    }
 
-            for (it = last_displayable + 1;
-                 it < ui->end() && it < last_displayable + count + 1;
-                 it++)
-            {
-                it->displayable = true;
-            }
+    // Edited text is kept in text buffer, content lines are wrapped from it
+    void Scene::OpenDocument(FontxFile *font)
+    {
+        document_font = font;
+        is_document_open = true;
+        wrap.Build(text, GetLineLength());
+        syntax.Build(wrap.GetRows());
+        journal.Clear();
 
-            size_t displayable_count = std::count_if(
-                GetContentUiStart(),
-                ui->end(),
-                [](auto &item)
-                { return item.displayable; });
+        ui->erase(GetContentUiStart(), ui->end());
+        viewport->offset = 0;
+        ResetViewport();
+        SetViewport(0);
+        PositionViewport();
+    }
 
-            if (displayable_count < lines_per_page - 1)
-            {
-                auto end{it + lines_per_page - displayable_count - 1};
+    void Scene::CloseDocument()
+    {
+        is_document_open = false;
+        text.Clear();
+        journal.Clear();
+        syntax.SetLanguage(CodeLanguage::Text);
+    }
 
-                for (; it < ui->end() && it < end; it++)
-                {
-                    it->displayable = true;
-                    displayable_count++;
-                }
+    // Syntax of opened document, content is drawn highlighted for code languages
+    void Scene::SetDocumentLanguage(CodeLanguage language)
+    {
+        syntax.SetLanguage(language);
+        if (is_document_open)
+        {
+            syntax.Build(wrap.GetRows());
+        }
+    }
 
-                for (it = ui->end() - displayable_count - 1;
-                     displayable_count < lines_per_page - 1 &&
-                     it > GetContentUiStart();
-                     it--)
-                {
-                    it->displayable = true;
-                    displayable_count++;
-                }
-            }
+    // Modal inputs and code log are edited as lines, main content through text buffer
+    bool Scene::IsDocumentEditing()
+    {
+        return is_document_open && ui == &main_ui;
+    }
 
-            return count;
+    // Offset in text buffer of position on content line
+    size_t Scene::GetDocumentOffset(size_t row, size_t column)
+    {
+        return wrap.GetRowStart(row) + column;
+    }
+
+    // Content line and column of text buffer offset, offset at line end goes to next line
+    void Scene::GetDocumentPosition(size_t offset, size_t &row, size_t &column)
+    {
+        row = wrap.GetRow(offset);
+        column = offset - wrap.GetRowStart(row);
+    }
+
+    // Put count wrapped rows from row into content lines, row is next to rows kept in ui
+    void Scene::InsertDocumentRows(size_t row, size_t count)
+    {
+        auto &theme{Settings::Settings::GetTheme()};
+        std::vector<UiStringItem> rows{};
+        rows.reserve(count);
+
+        for (size_t i = row; i < row + count; i++)
+        {
+            rows.push_back(UiStringItem{
+                text.Substr(wrap.GetRowStart(i), wrap.GetRowLength(i)),
+                theme.Colors.MainTextColor,
+                document_font,
+                false});
+            rows.back().displayable = false;
         }
 
-        if (direction == Direction::Up)
+        ui->insert(GetContentUiStart() + (row - viewport->offset), rows.begin(), rows.end());
+    }
+
+    // Keep rows around page in ui. Rows far from page are dropped, and rows are
+    // pulled from text buffer when page comes close to either end of kept ones,
+    // so a row is always kept above and below page while document has it.
+    void Scene::FitDocumentRows()
+    {
+        if (!IsDocumentEditing())
+            return;
+
+        size_t rows{wrap.GetRows()};
+        size_t first{viewport->first};
+        size_t last{std::min(rows, first + viewport->size)};
+        size_t offset{viewport->offset};
+        size_t end{offset + (ui->end() - GetContentUiStart())};
+
+        size_t keep_first{first > 2 * document_rows_margin ? first - 2 * document_rows_margin : 0};
+        size_t keep_end{last + 2 * document_rows_margin};
+
+        if (end <= keep_first || offset >= keep_end)
+        {
+            ui->erase(GetContentUiStart(), ui->end());
+            offset = end = viewport->offset = first;
+        }
+        if (end > keep_end)
         {
-            auto first_displayable = std::find_if(
-                ui->rbegin(),
-                ui->rend() - GetContentUiStartIndex(),
-                [](auto &item)
-                { return item.displayable; });
+            ui->erase(GetContentUiStart() + (keep_end - offset), ui->end());
+            end = keep_end;
+        }
+        if (offset < keep_first)
+        {
+            ui->erase(GetContentUiStart(), GetContentUiStart() + (keep_first - offset));
+            offset = viewport->offset = keep_first;
+        }
 
-            auto last_displayable = std::reverse_iterator(std::find_if(
-                                        GetContentUiStart(),
-                                        ui->end(),
-                                        [](auto &item)
-                                        { return item.displayable; })) -
-                                    1;
+        if (offset <= (first ? first - 1 : 0) && end >= std::min(rows, last + 1))
+            return;
 
-            if (last_displayable >= ui->rend() - 1 || first_displayable == ui->rend() - GetContentUiStartIndex())
-                return 0;
+        size_t load_first{first > document_rows_margin ? first - document_rows_margin : 0};
+        size_t load_end{std::min(rows, last + document_rows_margin)};
 
-            if (count > (last_displayable.base() - 1) - GetContentUiStart())
-            {
-                count = (last_displayable.base() - 1) - GetContentUiStart();
-            }
+        if (end < load_end)
+        {
+            InsertDocumentRows(end, load_end - end);
+        }
+        if (load_first < offset)
+        {
+            viewport->offset = load_first;
+            InsertDocumentRows(load_first, offset - load_first);
+        }
+    }
 
-            std::vector<UiStringItem>::reverse_iterator it{};
-            for (it = ui->rbegin();
-                 it < last_displayable &&
-                 it < first_displayable + count;
-                 it++)
-            {
-                it->displayable = false;
-            }
+    // Rewrap rows touched by text edit, only rows wrap index changed are replaced
+    WrapChange Scene::UpdateDocumentRows(size_t offset, size_t removed, size_t inserted, size_t first_displayable)
+    {
+        // Rows shift on page, it gets its flags again after rows are replaced
+        ShowViewport(false);
+        WrapChange change{wrap.Update(text, offset, removed, inserted)};
+        syntax.Update(change, wrap.GetRows());
+
+        size_t kept_first{viewport->offset};
+        size_t kept_end{kept_first + (ui->end() - GetContentUiStart())};
+
+        if (change.row + change.removed <= kept_first)
+        {
+            viewport->offset = kept_first + change.inserted - change.removed;
+        }
+        else if (change.row <= kept_end)
+        {
+            auto start{GetContentUiStart()};
+            auto first{start + (std::max(change.row, kept_first) - kept_first)};
+            auto last{start + (std::min(change.row + change.removed, kept_end) - kept_first)};
 
-            for (it = last_displayable + 1;
-                 it < ui->rend() && it < last_displayable + count + 1;
-                 it++)
+            // Rows kept in ui stay in one run, long insert cuts rows after it
+            viewport->offset = std::min(kept_first, change.row);
+            size_t limit{viewport->offset + viewport->size + 2 * document_rows_margin};
+            size_t count{change.inserted};
+            if (change.row + count > limit)
             {
-                it->displayable = true;
+                count = limit > change.row ? limit - change.row : 0;
+                last = ui->end();
             }
 
-            size_t displayable_count = std::count_if(
-                GetContentUiStart(),
-                ui->end(),
-                [](auto &item)
-                { return item.displayable; });
+            ui->erase(first, last);
+            InsertDocumentRows(change.row, count);
+        }
+
+        SetViewport(first_displayable);
+        PositionViewport();
 
-            if (displayable_count < lines_per_page)
-            {
-                auto end{it + lines_per_page - displayable_count};
+        return change;
+    }
+
+    // Put cursor at text buffer offset
+    void Scene::SpawnDocumentCursor(size_t offset, const WrapChange &change, size_t first_displayable, size_t scrolling, bool rerender)
+    {
+        size_t row, column;
+        GetDocumentPosition(offset, row, column);
+        SpawnContentCursor(row, column, change, first_displayable, scrolling, rerender);
+    }
+
+    // Put cursor on content row, scrolling by given step when it leaves page
+    // Changed rows are drawn again, rows below too when row count changed.
+    void Scene::SpawnContentCursor(size_t row, size_t column, const WrapChange &change, size_t first_displayable, size_t scrolling, bool rerender)
+    {
+        size_t lines_per_page{GetLinesPerPageCount()};
+        size_t step{std::max<size_t>(std::min(scrolling, lines_per_page - 1), 1)};
 
-                for (; it < ui->rend() - GetContentUiStartIndex() && it < end; it++)
+        size_t first{first_displayable};
+        if (row < first)
+        {
+            first = std::min(row, first > step ? first - step : 0);
+        }
+        else if (row >= first + lines_per_page)
+        {
+            first = std::min(row, std::max(row - (lines_per_page - 1), first + step));
+        }
+
+        if (first != first_displayable)
+        {
+            SetViewport(first);
+            PositionViewport();
+        }
+
+        if (rerender)
+        {
+            if (first != first_displayable)
+            {
+                RenderContent();
+            }
+            else
+            {
+                size_t last_row{first + lines_per_page - 1};
+                if (change.removed == change.inserted)
                 {
-                    it->displayable = true;
-                    displayable_count++;
+                    last_row = std::min(last_row, change.row + change.inserted - 1);
                 }
 
-                for (it = ui->rend() - GetContentUiStartIndex() - displayable_count - 1;
-                     displayable_count < lines_per_page &&
-                     it > ui->rbegin();
-                     it--)
+                if (change.row <= last_row && last_row >= first)
                 {
-                    it->displayable = true;
-                    displayable_count++;
+                    uint8_t first_line{static_cast<uint8_t>(change.row > first ? change.row - first : 0)};
+                    uint8_t last_line{static_cast<uint8_t>(last_row - first)};
+                    RenderLines(first_line, last_line, last_line == lines_per_page - 1);
                 }
             }
-
-            return count;
         }
 
-        return 0;
+        SpawnCursor(column, row - first, false, rerender);
     }
 
-    void Scene::CursorDeleteChars(size_t initial_count, size_t scrolling)
+    void Scene::DocumentInsertChars(const std::string &chars, size_t scrolling, bool rerender)
     {
-        if (!IsCursorControlling())
-            return;
+        size_t offset{GetDocumentOffset(viewport->first + cursor.y, cursor.x)};
+
+        journal.Record(text, offset, 0, chars.data(), chars.size());
+        DocumentReplaceRange(offset, offset, chars.data(), chars.size(), scrolling, rerender);
+    }
 
-        int16_t initial_x{cursor.x}, initial_y{cursor.y};
+    // Delete count chars before cursor
+    void Scene::DocumentDeleteChars(size_t count, size_t scrolling)
+    {
+        size_t offset{GetDocumentOffset(viewport->first + cursor.y, cursor.x)};
+        DocumentDeleteRange(offset - std::min(count, offset), offset, scrolling);
+    }
 
-        if (!initial_count)
+    void Scene::DocumentDeleteRange(size_t start, size_t end, size_t scrolling)
+    {
+        if (end <= start)
             return;
 
-        auto first_displaying = std::find_if(
-            GetContentUiStart(),
-            ui->end(),
-            [](auto &item)
-            { return item.displayable; });
+        journal.Record(text, start, end - start, nullptr, 0);
+        DocumentReplaceRange(start, end, nullptr, 0, scrolling, true);
+    }
+
+    // Replace text buffer chars [start, end) with count chars in one splice, rows
+    // are rewrapped from start row only until they line up with old ones again
+    void Scene::DocumentReplaceRange(size_t start, size_t end, const char *chars, size_t count, size_t scrolling, bool rerender)
+    {
+        auto first_displaying{GetDisplayStart()};
+        size_t first_displayable{viewport->first};
+
+        if (rerender && cursor.y < GetDisplayedCount())
+        {
+            ClearCursor(&*(first_displaying + cursor.y));
+        }
+
+        text.Erase(start, end - start);
+        text.Insert(start, chars, count);
+        WrapChange change{UpdateDocumentRows(start, end - start, count, first_displayable)};
+        SpawnDocumentCursor(start + count, change, first_displayable, scrolling, rerender);
+    }
+
+    // Apply edit taken from undo journal, cursor lands after its inserted chars
+    bool Scene::Undo()
+    {
+        UndoStep step;
+        if (!IsDocumentEditing() || !IsCursorControlling() || !journal.Undo(step))
+            return false;
+
+        if (selected.is_selected)
+        {
+            ResetSelecting();
+        }
+
+        DocumentReplaceRange(step.offset, step.offset + step.removed, step.text, step.inserted, GetLinesScroll(), true);
+        return true;
+    }
+
+    bool Scene::Redo()
+    {
+        UndoStep step;
+        if (!IsDocumentEditing() || !IsCursorControlling() || !journal.Redo(step))
+            return false;
 
-        if (initial_x < initial_count &&
-            first_displaying + initial_y == GetContentUiStart())
+        if (selected.is_selected)
         {
-            return;
+            ResetSelecting();
         }
 
-        size_t first_displaying_index{static_cast<size_t>(first_displaying - ui->begin())};
-        size_t count{initial_count};
-        size_t start_line_index{first_displaying_index + initial_y};
+        DocumentReplaceRange(step.offset, step.offset + step.removed, step.text, step.inserted, GetLinesScroll(), true);
+        return true;
+    }
+
+    // Select next or previous match of find pattern from cursor, search wraps
+    // around document ends. Cursor lands after match, as after selecting it.
+    bool Scene::FindText(bool forward, bool rerender)
+    {
+        if (!IsDocumentEditing() || !IsCursorControlling() || finder.IsEmpty())
+            return false;
 
-        if (start_line_index == ui->size() - 1 && (*ui)[start_line_index].label.size() == 0)
+        size_t offset{GetDocumentOffset(viewport->first + cursor.y, cursor.x)};
+        if (!forward && selected.is_selected)
         {
-            ClearCursor(&(*ui)[start_line_index]);
+            offset = GetDocumentOffset(selected.start_y, selected.start_x);
         }
 
-        if (initial_x < initial_count)
+        size_t match{forward ? finder.FindNext(text, offset) : finder.FindPrev(text, offset)};
+        if (match == SIZE_MAX)
         {
-            int64_t count{static_cast<int64_t>(initial_count)};
-
-            while (count > 0)
-            {
-                if (initial_x >= count)
-                {
-                    initial_x -= count;
-                    break;
-                }
-                else
-                {
-                    count -= initial_x;
-
-                    if (start_line_index != GetContentUiStartIndex())
-                    {
-                        initial_x = (*ui)[--start_line_index].label.size() - 1;
-
-                        count--;
-                        initial_y--;
-                    }
-                }
-            }
+            match = forward ? finder.FindNext(text, 0) : finder.FindPrev(text, text.Size());
         }
-        else
+
+        if (match == SIZE_MAX)
         {
-            initial_x -= count;
+            ESP_LOGD(TAG, "Text not found: %s", finder.GetPattern().c_str());
+            return false;
         }
 
-        size_t delete_x{static_cast<size_t>(initial_x)};
-        uint8_t lines_per_page = GetLinesPerPageCount();
-        size_t line_index{start_line_index};
-
-        while (count > 0)
+        if (selected.is_selected)
         {
-            UiStringItem &line{(*ui)[line_index]};
-            auto begin{line.label.begin() + delete_x};
-            auto end{begin + count > line.label.end() ? line.label.end() : begin + count};
-            size_t curr_line_count{static_cast<size_t>(end - begin)};
-
-            line.label.erase(begin, end);
-            count -= curr_line_count;
-
-            if (count)
-            {
-                delete_x = 0;
-                line_index++;
-            }
+            ResetSelecting(rerender);
         }
 
-        size_t last_changed_index{start_line_index};
-        for (size_t i{start_line_index}; i < ui->size() - 1; i++)
+        journal.Break();
+        if (rerender && cursor.y < GetDisplayedCount())
         {
-            UiStringItem &line{(*ui)[i]};
+            ClearCursor(&*(GetDisplayStart() + cursor.y));
+        }
 
-            if (!(line.label.size() < GetLineLength() &&
-                  (!line.label.size() ||
-                   line.label[line.label.size() - 1] != '\n')))
-            {
-                break;
-            }
+        // No rows changed, page only moves to match
+        size_t end{match + finder.GetPattern().size()};
+        SpawnDocumentCursor(end, WrapChange{wrap.GetRows(), 0, 0}, viewport->first, GetLinesScroll(), rerender);
 
-            size_t next_line_index{i + 1};
-            UiStringItem *next_line{&(*ui)[next_line_index]};
-            while (line.label.size() < GetLineLength())
-            {
-                while (next_line->label.size() == 0 &&
-                       line.label.size() < GetLineLength() &&
-                       next_line_index < ui->size() - 1)
-                {
-                    next_line_index++;
-                    next_line = &(*ui)[next_line_index];
-                }
+        GetDocumentPosition(match, selected.start_y, selected.start_x);
+        GetDocumentPosition(end, selected.end_y, selected.end_x);
+        selected.is_selected = true;
 
-                if (next_line->label.size() == 0)
-                    break;
+        if (rerender)
+        {
+            UpdateSelecting();
+            RenderCursor();
+        }
 
-                char curr = next_line->label[0];
-                line.label.push_back(curr);
-                next_line->label.erase(next_line->label.begin());
+        return true;
+    }
 
-                if (curr == '\n')
-                    break;
-            }
+    // Replace every match of find pattern at once. Text from first to last match
+    // is built with replacements and spliced in, so it is one undo step too.
+    size_t Scene::ReplaceAll(const std::string &replacement, bool rerender)
+    {
+        if (!IsDocumentEditing() || finder.IsEmpty())
+            return 0;
 
-            if (next_line->label.size())
-            {
-                last_changed_index = next_line_index;
-            }
-            else if (line.label.size())
-            {
-                last_changed_index = i;
-            }
-        }
+        std::string replaced{};
+        size_t start{}, end{};
+        size_t count{finder.ReplaceAll(text, replacement, start, end, replaced)};
+
+        ESP_LOGD(TAG, "Replaced %zu matches", count);
+        if (!count)
+            return 0;
 
-        int erased_count{};
-        for (auto it{ui->rbegin()};
-             it < ui->rend() - GetContentUiStartIndex() - 1 &&
-             it->label.size() == 0 && !((it + 1)->label.ends_with('\n'));
-             it++)
+        if (selected.is_selected)
         {
-            erased_count++;
-            ui->erase(it.base() - 1);
+            ResetSelecting(rerender);
         }
 
-        size_t displayable_count = std::count_if(
-            GetContentUiStart(),
-            ui->end(),
-            [](auto &item)
-            { return item.displayable; });
+        journal.Record(text, start, end - start, replaced.data(), replaced.size());
+        DocumentReplaceRange(start, end, replaced.data(), replaced.size(), GetLinesScroll(), rerender);
+        return count;
+    }
 
-        auto last_displayable_find_end{ui->rend() - GetContentUiStartIndex()};
-        std::vector<UiStringItem>::iterator last_displayable{
-            std::find_if(
-                ui->rbegin(),
-                last_displayable_find_end,
-                [](auto &item)
-                { return item.displayable; })
-                .base() -
-            1};
+    void Scene::CursorDeleteChars(size_t count, size_t scrolling)
+    {
+        if (!IsCursorControlling() || !count)
+            return;
 
-        if (last_displayable != last_displayable_find_end.base() - 1)
+        if (IsDocumentEditing())
         {
-            for (auto it{last_displayable + 1};
-                 it < ui->end() &&
-                 displayable_count < lines_per_page;
-                 it++, displayable_count++)
-            {
-                it->displayable = true;
-            }
+            DocumentDeleteChars(count, scrolling);
+            return;
         }
 
-        last_changed_index -= first_displaying_index;
+        if (GetDisplayStart() == ui->end())
+            return;
+
+        // Walk back count chars from cursor over content lines
+        size_t end_row{viewport->first + cursor.y};
+        size_t end_column{std::min<size_t>(cursor.x, GetContentRowLength(end_row))};
+        size_t row{end_row}, column{end_column};
 
-        size_t scrolled{};
-        while (initial_y < 0 && scrolling > 0)
+        while (count > column && row > 0)
         {
-            scrolled = ScrollContent(Direction::Up, false, scrolling);
-            initial_y += scrolled;
+            count -= column;
+            column = GetContentRowLength(--row);
         }
+        column -= std::min(count, column);
 
-        if (initial_y > displayable_count - 1 && initial_y < lines_per_page)
-        {
-            CursorAppendLine();
-        }
+        if (row == end_row && column == end_column)
+            return;
+
+        SpliceLines(row, column, end_row, end_column, "", scrolling, true);
+    }
 
-        size_t first_rerender_line_index{static_cast<size_t>(scrolled > 0 ? 0 : initial_y)};
-        size_t last_rerender_line_index{static_cast<size_t>(erased_count
-                                                                ? lines_per_page - 1
-                                                            : (last_changed_index > lines_per_page - 1)
-                                                                ? lines_per_page - 1
-                                                                : last_changed_index)};
+    // Delete selected chars in one splice, cursor goes to selection start
+    void Scene::DeleteSelected()
+    {
+        Selected range{selected};
+        ResetSelecting(false);
 
-        if (first_displaying + last_rerender_line_index > ui->end() - 1 || scrolled > 0)
+        if (IsDocumentEditing())
         {
-            RenderContent();
+            DocumentDeleteRange(GetDocumentOffset(range.start_y, range.start_x),
+                                GetDocumentOffset(range.end_y, range.end_x),
+                                GetLinesScroll());
         }
         else
         {
-            RenderLines(
-                first_rerender_line_index,
-                last_rerender_line_index,
-                first_displaying + last_rerender_line_index == ui->end() - 1,
-                initial_x);
+            SpliceLines(range.start_y, range.start_x, range.end_y, range.end_x, "", GetLinesScroll(), true);
         }
-
-        SpawnCursor(initial_x, initial_y, first_displaying + cursor.y < ui->end());
     }
 
     void Scene::CursorAppendLine(const char *label, Color color)
@@ -1167,10 +1684,11 @@ namespace Scene
 
         UiStringItem last_line{label, color, (ui->end() - 1)->font, false};
         uint8_t fw, fh;
-        Font::GetFontx((ui->end() - 1)->font, 0, &fw, &fh);
+        Font::GetFontSize((ui->end() - 1)->font, &fw, &fh);
 
         last_line.x = 10;
         last_line.y = (ui->end() - 1)->y - fh;
+        last_line.displayable = GetContentRows() < viewport->first + viewport->size;
         ui->push_back(last_line);
     }
 
@@ -1178,7 +1696,7 @@ namespace Scene
     {
         UiStringItem last_line{label, color, line_before->font, false};
         uint8_t fw, fh;
-        Font::GetFontx(line_before->font, 0, &fw, &fh);
+        Font::GetFontSize(line_before->font, &fw, &fh);
 
         last_line.x = line_before->x;
         last_line.y = line_before->y - fh;
@@ -1191,178 +1709,135 @@ namespace Scene
         ui->insert(line_before + 1, last_line);
     }
 
-    void Scene::CursorInsertChars(std::string chars, size_t scrolling, bool rerender)
+    void Scene::CursorInsertChars(const std::string &chars, size_t scrolling, bool rerender)
     {
         if (!chars.size())
             return;
 
         ESP_LOGD(TAG, "Inserting %s", chars.c_str());
 
-        size_t inserting_len = chars.size();
-        uint8_t insert_x{cursor.x}, last_insert_y{cursor.y};
-        const uint8_t insert_x_initial{cursor.x}, first_insert_y{cursor.y},
-            initial_cursor_x{cursor.x},
-            initial_cursor_y{cursor.y};
+        if (IsDocumentEditing())
+        {
+            DocumentInsertChars(chars, scrolling, rerender);
+        }
+        else if (GetDisplayStart() != ui->end())
+        {
+            size_t row{viewport->first + cursor.y};
+            SpliceLines(row, cursor.x, row, cursor.x, chars, scrolling, rerender);
+        }
+    }
 
-        auto first_displaying = std::find_if(
-            GetContentUiStart(),
-            ui->end(),
-            [](auto &item)
-            { return item.displayable; });
+    // Replace chars from row, column to end_row, end_column of content lines with
+    // given ones in one splice. Lines from row to the one ending paragraph after
+    // end_row ('\n' or not full) are wrapped again, and cursor lands where given
+    // chars end.
+    void Scene::SpliceLines(size_t row, size_t column, size_t end_row, size_t end_column,
+                            const std::string &chars, size_t scrolling, bool rerender)
+    {
+        size_t rows{GetContentRows()};
 
-        if (first_displaying == ui->end())
+        if (end_row >= rows || row > end_row)
         {
-            ESP_LOGE(TAG, "First displaying not found");
+            ESP_LOGE(TAG, "Spliced lines not found");
             return;
         }
 
-        size_t first_displaying_index{static_cast<size_t>(first_displaying - ui->begin())};
-        auto start_line_index{first_displaying_index + first_insert_y};
+        auto first_displaying{GetDisplayStart()};
+        size_t first_displayable{viewport->first};
+        size_t line_length{GetLineLength()};
+        auto start{GetContentUiStart()};
+        UiStringItem &line{*(start + row)};
+        const std::string &end_label{(start + end_row)->label};
 
-        size_t scrolled_count{0};
+        if (rerender && cursor.y < GetDisplayedCount())
+        {
+            ClearCursor(&*(first_displaying + cursor.y));
+        }
 
-        for (size_t line_index{start_line_index}; line_index < ui->size(); line_index++)
+        size_t paragraph_end{end_row};
+        while (paragraph_end < rows - 1)
         {
-            if (!chars.size())
+            const std::string &label{(start + paragraph_end)->label};
+            if (label.size() < line_length || label.back() == '\n')
                 break;
 
-            if (line_index > start_line_index)
-            {
-                last_insert_y++;
-            }
-
-            size_t line_length{GetLineLength()};
-            UiStringItem &line{(*ui)[line_index]};
+            paragraph_end++;
+        }
 
-            int size = chars.size();
-            if (line.label.size() + size > line_length)
-            {
-                chars.append(line.label, insert_x);
-                line.label.erase(insert_x);
+        column = std::min(column, line.label.size());
+        end_column = std::max(std::min(end_column, end_label.size()), row == end_row ? column : 0);
 
-                size = line_length - line.label.size();
-            }
+        std::string paragraph{};
+        paragraph.reserve((paragraph_end - row + 1) * line_length + chars.size());
+        paragraph.append(line.label, 0, column);
+        paragraph.append(chars);
+        size_t cursor_offset{paragraph.size()};
+        paragraph.append(end_label, end_column);
+        for (auto it{start + end_row + 1}; it <= start + paragraph_end; it++)
+        {
+            paragraph.append(it->label);
+        }
 
-            for (int i = 0; i < size; i++)
-            {
-                line.label.insert(line.label.begin() + insert_x, chars[0]);
-                chars.erase(chars.begin());
-                insert_x++;
-            }
+        std::vector<UiStringItem> lines{};
+        lines.reserve(paragraph.size() / line_length + 2);
+        size_t cursor_row{SIZE_MAX}, cursor_column{};
 
-            if (chars.size())
+        for (size_t offset{}; offset < paragraph.size();)
+        {
+            size_t length{std::min(line_length, paragraph.size() - offset)};
+            const char *newline{static_cast<const char *>(memchr(paragraph.data() + offset, '\n', length))};
+            if (newline)
             {
-                insert_x = 0;
+                length = newline - (paragraph.data() + offset) + 1;
             }
 
-            size_t find_index = std::string::npos;
-            if ((find_index = line.label.find('\n')) != std::string::npos)
+            if (cursor_row == SIZE_MAX && cursor_offset < offset + length)
             {
-                for (auto it{line.label.rbegin()};
-                     it < line.label.rend() - find_index - 1; it++)
-                {
-                    chars.insert(chars.begin(), *it);
-                }
-
-                line.label.erase(
-                    line.label.begin() + find_index + 1,
-                    line.label.end());
-
-                insert_x = 0;
+                cursor_row = lines.size();
+                cursor_column = cursor_offset - offset;
             }
 
-            if (line_index == (ui->size() - 1) &&
-                (chars.size() ||
-                 line.label[line.label.size() - 1] == '\n' ||
-                 (line.label.size() == GetLineLength() && cursor.x == line.label.size() - 1)))
-            {
-                bool is_new_line_displayable{!(ui->size() - first_displaying_index >= GetLinesPerPageCount())};
-                bool is_cursor_moving{cursor.y == line_index - first_displaying_index &&
-                                      cursor.x == line.label.size() - 1 &&
-                                      !chars.size()};
-
-                CursorAppendLine();
-
-                if (!is_new_line_displayable)
-                {
-                    (ui->end() - 1)->displayable = false;
-                }
-
-                if (is_cursor_moving)
-                {
-                    scrolled_count += MoveCursor(Direction::Right, false, 1);
-                }
-            }
+            lines.push_back(UiStringItem{paragraph.substr(offset, length), line.color, line.font, false});
+            lines.back().displayable = false;
+            offset += length;
         }
 
-        size_t cursor_scrolling_count{0};
-        if (scrolling > 0)
-        {
-            cursor_scrolling_count = last_insert_y - first_insert_y <= scrolling
-                                         ? scrolling
-                                         : last_insert_y - first_insert_y;
-        }
+        // Cursor after closed line goes to start of next one
+        bool is_last_closed{lines.empty() ||
+                            lines.back().label.size() == line_length ||
+                            lines.back().label.back() == '\n'};
 
-        first_displaying_index += scrolled_count;
-        for (int i{}; i < inserting_len; i++)
+        if (cursor_row == SIZE_MAX)
         {
-            size_t scrolled = MoveCursor(Direction::Right, false, cursor_scrolling_count);
-            scrolled_count += scrolled;
-            if (scrolled)
-            {
-                first_displaying_index += scrolled;
-                if (first_displaying_index < ui->size())
-                {
-                    size_t fd_label_size{(*ui)[first_displaying_index].label.size()};
-                    for (int i{}; i < fd_label_size; i++)
-                    {
-                        MoveCursor(Direction::Right, false, cursor_scrolling_count);
-                    }
-                }
-                else
-                {
-                    ESP_LOGE(TAG, "First displaying not found.");
-                }
-            }
+            cursor_row = is_last_closed ? lines.size() : lines.size() - 1;
+            cursor_column = is_last_closed ? 0 : lines.back().label.size();
         }
 
-        if (rerender)
-        {
-            if (scrolled_count > 0)
-            {
-                RenderContent();
-            }
-            else
-            {
-                if (last_insert_y > GetLinesPerPageCount() - 1)
-                {
-                    last_insert_y = GetLinesPerPageCount() - 1;
-                }
-
-                RenderLines(first_insert_y, last_insert_y, false, insert_x_initial);
-            }
-        }
-        else
+        // Keep last content line open for typing
+        if (paragraph_end == rows - 1 && is_last_closed)
         {
-            display.SetListPositions(GetContentUiStart(),
-                                     ui->end(),
-                                     10,
-                                     display.GetHeight() - 60,
-                                     GetLinesPerPageCount());
+            lines.push_back(UiStringItem{"", line.color, line.font, false});
+            lines.back().displayable = false;
         }
 
-        if (scrolled_count == 0 && rerender)
-        {
-            ClearCursor(&(*ui)[start_line_index], initial_cursor_x, initial_cursor_y);
-        }
+        WrapChange change{row, paragraph_end - row + 1, lines.size()};
+
+        // Content start of modal input moves with ui end, lines go where erased ones were
+        ShowViewport(false);
+        auto spliced{ui->erase(start + row, start + paragraph_end + 1)};
+        ui->insert(spliced,
+                   std::make_move_iterator(lines.begin()),
+                   std::make_move_iterator(lines.end()));
+        SetViewport(first_displayable);
+        PositionViewport();
 
-        SpawnCursor(-1, -1, false, rerender);
+        SpawnContentCursor(row + cursor_row, cursor_column, change, first_displayable, scrolling, rerender);
     }
 
     void Scene::CursorInit(FontxFile *font, uint8_t x, uint8_t y)
     {
         uint8_t fw, fh;
-        Font::GetFontx(font, 0, &fw, &fh);
+        Font::GetFontSize(font, &fw, &fh);
         cursor.x = x;
         cursor.y = y;
         cursor.width = fw;
@@ -1391,6 +1866,8 @@ namespace Scene
 
     void Scene::RenderModal()
     {
+        rendered.ui = nullptr;
+        cursor_shown = false;
         display.Clear(Settings::Settings::GetTheme().Colors.MainBackgroundColor);
         std::for_each(
             ui->begin(),
@@ -1406,12 +1883,16 @@ namespace Scene
 
     void Scene::RenderModalContent()
     {
+        if (RenderContentShifted())
+            return;
+
         display.Clear(Settings::Settings::GetTheme().Colors.MainBackgroundColor, 10, 0, display.GetWidth(), display.GetHeight() - 35);
-        display.DrawStringItems(GetContentUiStart(),
-                                ui->end(),
+        display.DrawStringItems(GetDisplayStart(),
+                                GetDisplayStart() + GetDisplayedCount(),
                                 10,
                                 display.GetHeight() - 60,
-                                GetLinesPerPageCount());
+                                GetDisplayedCount());
+        SaveRenderedContent();
     }
 
     void Scene::EnterModalControlling()
@@ -1428,6 +1909,8 @@ namespace Scene
         }
 
         ui = &modal.ui;
+        viewport = &modal.viewport;
+        SyncViewport();
         RenderModal();
     }
 
@@ -1445,10 +1928,12 @@ namespace Scene
         if (IsHomeStage(stage))
         {
             ui = &main_ui;
+            viewport = &main_viewport;
         }
         else if (IsModalStage(stage))
         {
             ui = &GetStageModal(stage).ui;
+            viewport = &GetStageModal(stage).viewport;
         }
 
         SetStage(stage);
@@ -1489,12 +1974,12 @@ namespace Scene
         display.SetPosition(&label_item, Position::NotSpecified, Position::End);
 
         uint8_t fw{}, fh{};
-        Font::GetFontx(label_item.font, 0, &fw, &fh);
+        Font::GetFontSize(label_item.font, &fw, &fh);
 
         std::vector<std::string> label_words{};
 
         std::string word{};
-        for (int i{}; i < modal_label.size(); i++)
+        for (size_t i{}; i < modal_label.size(); i++)
         {
             if (modal_label[i] != ' ')
             {
@@ -1509,7 +1994,7 @@ namespace Scene
         }
 
         size_t line_num{0};
-        for (int i{}; i < label_words.size(); i++)
+        for (size_t i{}; i < label_words.size(); i++)
         {
             label_item.label += label_words[i] + ' ';
 
@@ -1552,6 +2037,8 @@ namespace Scene
 
     void Scene::ClearContent(Color color)
     {
+        rendered.ui = nullptr;
+        cursor_shown = false;
         if (color == Color::None)
         {
             color = Settings::Settings::GetTheme().Colors.MainBackgroundColor;
@@ -1658,7 +2145,7 @@ namespace Scene
                 if (ScrollContent(direction, false, GetLinesScroll()) > 0)
                 {
                     RenderModalContent();
-                    if (!(ui->end() - 1)->displayable)
+                    if (!IsContentEndDisplayed())
                     {
                         RenderUiListEnding("more log lines...");
                     }
@@ -1693,6 +2180,165 @@ namespace Scene
         AddStageModal(code_run_stage, modal);
     }
 
+    // Input for find pattern or, when modal data is "replace", for text replacing
+    // its matches. Document cursor is kept aside while input has the cursor.
+    void Scene::InitFindModal(uint8_t find_stage, uint8_t home_stage)
+    {
+        Modal modal{};
+        auto &theme{Settings::Settings::GetTheme()};
+
+        modal.ui.push_back(UiStringItem{"Ok", theme.Colors.MainTextColor, display.fx24G});
+        display.SetPosition(&*(modal.ui.end() - 1), Position::Start, Position::Start);
+
+        modal.ui.push_back(UiStringItem{"Cancel", theme.Colors.MainTextColor, display.fx24G});
+        display.SetPosition(&*(modal.ui.end() - 1), Position::End, Position::Start);
+
+        modal.ui.push_back(UiStringItem{"", theme.Colors.MainTextColor, display.fx24G, false});
+        (modal.ui.end() - 1)->x = 70;
+        display.SetPosition(&*(modal.ui.end() - 1), Position::NotSpecified, Position::Center);
+
+        modal.PreEnter = [this, find_stage]()
+        {
+            Modal &modal{GetStageModal(find_stage)};
+            find_cursor = cursor;
+
+            if (modal.data == "replace")
+            {
+                AddModalLabel("Replace " + finder.GetPattern() + " with:", modal);
+            }
+            else
+            {
+                (modal.ui.end() - 1)->label = finder.GetPattern();
+                AddModalLabel("Find:", modal);
+            }
+
+            CursorInit(display.fx24G, (modal.ui.end() - 1)->label.length(), 0);
+            SetCursorControlling(true);
+        };
+
+        modal.PreLeave = [this]()
+        {
+            ui->erase(ui->begin(), ui->end() - 3);
+
+            // Nothing is focused when modal is left from input
+            if (!IsCursorControlling())
+            {
+                auto focused{GetFocused()};
+                if (focused != ui->end())
+                    ChangeItemFocus(&(*focused), false);
+            }
+
+            Modal &modal{GetStageModal()};
+            modal.data.clear();
+            (modal.ui.end() - 1)->label.clear();
+
+            cursor = find_cursor;
+            SetCursorControlling(true);
+        };
+
+        modal.Arrow = [this](Direction direction)
+        {
+            if (!IsCursorControlling() && direction == Direction::Up)
+            {
+                SetCursorControlling(true);
+                auto focused{GetFocused()};
+
+                if (focused != ui->end())
+                {
+                    ChangeItemFocus(&*focused, false, true);
+                }
+            }
+            else if (IsCursorControlling())
+            {
+                if (direction == Direction::Left ||
+                    direction == Direction::Right)
+                {
+                    MoveCursor(direction);
+                }
+                else if (direction == Direction::Bottom)
+                {
+                    SetCursorControlling(false);
+                    ChangeItemFocus(&*(ui->end() - 3), true, true);
+                }
+            }
+            else
+            {
+                Focus(direction);
+            }
+        };
+
+        modal.Value = [this](char value, bool is_ctrl_pressed)
+        {
+            if (!IsCursorControlling() || is_ctrl_pressed)
+                return;
+
+            if (value == '\n')
+            {
+                GetStageModal().Ok();
+            }
+            else if (isprint(static_cast<unsigned char>(value)) &&
+                     (ui->end() - 1)->label.size() < max_find_pattern_size)
+            {
+                CursorInsertChars(std::string(1, value), GetLinesScroll());
+            }
+        };
+
+        // Document is drawn once after modal is left and input is applied
+        modal.Ok = [this, home_stage]()
+        {
+            Modal &modal{GetStageModal()};
+            std::string input{(modal.ui.end() - 1)->label};
+            bool replacing{modal.data == "replace"};
+
+            LeaveModalControlling(home_stage, false);
+
+            if (replacing)
+            {
+                ReplaceAll(input, false);
+            }
+            else
+            {
+                finder.SetPattern(input);
+                FindText(true, false);
+            }
+
+            RenderAll();
+            if (selected.is_selected)
+            {
+                UpdateSelecting();
+                RenderCursor();
+            }
+        };
+
+        modal.Cancel = [this, home_stage]()
+        {
+            LeaveModalControlling(home_stage);
+        };
+
+        AddStageModal(find_stage, modal);
+    }
+
+    void Scene::OpenFindModal(uint8_t find_stage, bool replacing)
+    {
+        if (!IsDocumentEditing() || !IsCursorControlling() || !IsModalStage(find_stage))
+            return;
+
+        if (replacing && finder.IsEmpty())
+        {
+            ESP_LOGD(TAG, "Nothing to replace, find pattern is empty");
+            return;
+        }
+
+        if (selected.is_selected)
+        {
+            ResetSelecting(false);
+        }
+
+        GetStageModal(find_stage).data = replacing ? "replace" : "find";
+        SetStage(find_stage);
+        EnterModalControlling();
+    }
+
     void Scene::Paste()
     {
         if (clipboard.is_file_copied || !IsCursorControlling())
@@ -1712,17 +2358,8 @@ namespace Scene
 
     void Scene::ScrollToEnd()
     {
-        for (auto it{GetContentUiStart()}; it < ui->end(); it++)
-        {
-            if (ui->end() - it > GetLinesPerPageCount())
-            {
-                it->displayable = false;
-            }
-            else
-            {
-                it->displayable = true;
-            }
-        }
+        size_t rows{GetContentRows()};
+        SetViewport(rows > viewport->size ? rows - viewport->size : 0);
     }
 
     void Scene::SendCodeOutput(const char *output)
@@ -1744,6 +2381,7 @@ namespace Scene
         size_t max_line_len = GetLineLength();
         UiStringItem error_line{"", Settings::Settings::GetTheme().Colors.CodeErrorColor,
                                 GetContentUiStart()->font, false};
+        error_line.displayable = false;
 
         size_t index = 0;
         size_t find_n{std::string::npos};
@@ -1766,7 +2404,7 @@ namespace Scene
         }
 
         ScrollToEnd();
-        display.SetListPositions(GetContentUiStart(), ui->end(), 10, display.GetHeight() - 60, GetLinesPerPageCount());
+        PositionViewport();
     }
 
     void Scene::SendCodeSuccess()
@@ -1777,10 +2415,11 @@ namespace Scene
         ESP_LOGD(TAG, "Code Successfully executed.");
 
         UiStringItem end_item{"Successfully executed.", Settings::Settings::GetTheme().Colors.CodeSuccessColor, GetContentUiStart()->font, false};
+        end_item.displayable = false;
         ui->push_back(end_item);
 
         ScrollToEnd();
-        display.SetListPositions(GetContentUiStart(), ui->end(), 10, display.GetHeight() - 60, GetLinesPerPageCount());
+        PositionViewport();
     }
 
     void Scene::DisplayCodeLog(bool code_end)
@@ -1816,7 +2455,7 @@ namespace Scene
             [](UiStringItem *last_f, UiStringItem *new_f)
             {
                 uint8_t fh{};
-                Font::GetFontx(last_f->font, 0, 0, &fh);
+                Font::GetFontSize(last_f->font, 0, &fh);
                 return new_f->y >= last_f->y - fh;
             }};
 
@@ -1828,21 +2467,18 @@ namespace Scene
 
     void Scene::Select(Direction direction, bool rerender)
     {
-        size_t ui_start{GetContentUiStartIndex(GetStage())};
+        journal.Break();
+        size_t last_row{GetContentRows() - 1};
 
         if (selected.start_x == 0 && selected.start_y == 0 &&
-            selected.end_x == (*ui)[ui->size() - 1].label.length() &&
-            selected.end_y == ui->size() - 1 - ui_start)
+            selected.end_x == GetContentRowLength(last_row) &&
+            selected.end_y == last_row)
         {
             ResetSelecting();
         }
 
         bool is_start_point{};
-        auto first_displaying{
-            std::find_if(GetContentUiStart(),
-                         ui->end(),
-                         [](auto &item)
-                         { return item.displayable; })};
+        auto first_displaying{GetDisplayStart()};
 
         if (first_displaying == ui->end())
         {
@@ -1857,13 +2493,13 @@ namespace Scene
             is_start_point = direction == Direction::Left || direction == Direction::Up;
 
             selected.end_y = selected.start_y =
-                static_cast<size_t>(first_displaying - GetContentUiStart()) + cursor.y;
+                viewport->first + cursor.y;
             selected.end_x = selected.start_x = cursor.x;
         }
         else
         {
             is_start_point = cursor.x == selected.start_x &&
-                             (first_displaying - GetContentUiStart() + cursor.y) == selected.start_y;
+                             viewport->first + cursor.y == selected.start_y;
         }
 
         size_t last_line_x;
@@ -1873,13 +2509,13 @@ namespace Scene
             if (is_start_point && selected.start_y > 0)
             {
                 selected.start_y--;
-                last_line_x = (*ui)[ui_start + selected.start_y].label.length() - 1;
+                last_line_x = GetContentRowLength(selected.start_y) - 1;
                 selected.start_x = selected.start_x > last_line_x ? last_line_x : selected.start_x;
             }
             else if (!is_start_point && selected.end_y > 0)
             {
                 selected.end_y--;
-                last_line_x = (*ui)[ui_start + selected.end_y].label.length() - 1;
+                last_line_x = GetContentRowLength(selected.end_y) - 1;
                 selected.end_x = selected.end_x > last_line_x ? last_line_x : selected.end_x;
             }
         }
@@ -1887,12 +2523,12 @@ namespace Scene
         {
             if (is_start_point)
             {
-                last_line_x = (*ui)[ui_start + selected.start_y].label.length() - 1;
+                last_line_x = GetContentRowLength(selected.start_y) - 1;
                 if (selected.start_x < last_line_x)
                 {
                     selected.start_x++;
                 }
-                else if (ui_start + selected.start_y < ui->size() - 1)
+                else if (selected.start_y < last_row)
                 {
                     selected.start_x = 0;
                     selected.start_y++;
@@ -1900,15 +2536,15 @@ namespace Scene
             }
             else
             {
-                last_line_x = (*ui)[ui_start + selected.end_y].label.length() - 1;
-                if (ui_start + selected.end_y == ui->size() - 1)
+                last_line_x = GetContentRowLength(selected.end_y) - 1;
+                if (selected.end_y == last_row)
                     last_line_x++;
 
                 if (selected.end_x < last_line_x)
                 {
                     selected.end_x++;
                 }
-                else if (ui_start + selected.end_y < ui->size() - 1)
+                else if (selected.end_y < last_row)
                 {
                     selected.end_x = 0;
                     selected.end_y++;
@@ -1917,17 +2553,17 @@ namespace Scene
         }
         else if (direction == Direction::Bottom)
         {
-            if (is_start_point && ui_start + selected.start_y < ui->size() - 1)
+            if (is_start_point && selected.start_y < last_row)
             {
                 selected.start_y++;
-                last_line_x = (*ui)[ui_start + selected.start_y].label.length() - 1;
+                last_line_x = GetContentRowLength(selected.start_y) - 1;
                 selected.start_x = selected.start_x > last_line_x ? last_line_x : selected.start_x;
             }
-            else if (!is_start_point && ui_start + selected.end_y < ui->size() - 1)
+            else if (!is_start_point && selected.end_y < last_row)
             {
                 selected.end_y++;
-                last_line_x = (*ui)[ui_start + selected.end_y].label.length() - 1;
-                if (ui_start + selected.end_y == ui->size() - 1)
+                last_line_x = GetContentRowLength(selected.end_y) - 1;
+                if (selected.end_y == last_row)
                     last_line_x++;
 
                 selected.end_x = selected.end_x > last_line_x ? last_line_x : selected.end_x;
@@ -1944,7 +2580,7 @@ namespace Scene
                 else if (selected.start_y > 0)
                 {
                     selected.start_y--;
-                    last_line_x = (*ui)[ui_start + selected.start_y].label.length() - 1;
+                    last_line_x = GetContentRowLength(selected.start_y) - 1;
                     selected.start_x = last_line_x;
                 }
             }
@@ -1957,7 +2593,7 @@ namespace Scene
                 else if (selected.end_y > 0)
                 {
                     selected.end_y--;
-                    last_line_x = (*ui)[ui_start + selected.start_y].label.length() - 1;
+                    last_line_x = GetContentRowLength(selected.end_y) - 1;
                     selected.end_x = last_line_x;
                 }
             }
@@ -2017,11 +2653,7 @@ namespace Scene
 
     void Scene::RenderSelecting(uint8_t offset)
     {
-        auto first_displaying{
-            std::find_if(GetContentUiStart(),
-                         ui->end(),
-                         [](auto &item)
-                         { return item.displayable; })};
+        auto first_displaying{GetDisplayStart()};
 
         if (first_displaying == ui->end())
         {
@@ -2029,28 +2661,25 @@ namespace Scene
             return;
         }
 
-        size_t first_displaying_index{static_cast<size_t>(first_displaying - ui->begin())};
-        size_t lines_per_page{GetLinesPerPageCount()};
-        size_t ui_start{GetContentUiStartIndex(GetStage())};
+        size_t count{GetDisplayedCount()};
 
-        for (size_t i{first_displaying_index + offset};
-             i < ui->size() &&
-             i < first_displaying_index + lines_per_page;
-             i++)
+        for (size_t line{offset}; line < count; line++)
         {
-            if (i - ui_start < selected.start_y)
+            size_t row{viewport->first + line};
+
+            if (row < selected.start_y)
             {
                 continue;
             }
 
-            if (i - ui_start > selected.end_y)
+            if (row > selected.end_y)
             {
                 break;
             }
 
-            uint8_t cur_sx{static_cast<uint8_t>(selected.start_y < i - ui_start ? 0 : selected.start_x)},
-                cur_y{static_cast<uint8_t>(i - first_displaying_index)},
-                cur_ex{static_cast<uint8_t>(selected.end_y > i - ui_start ? (*ui)[i].label.length() : selected.end_x)};
+            uint8_t cur_sx{static_cast<uint8_t>(selected.start_y < row ? 0 : selected.start_x)},
+                cur_y{static_cast<uint8_t>(line)},
+                cur_ex{static_cast<uint8_t>(selected.end_y > row ? (first_displaying + line)->label.length() : selected.end_x)};
 
             uint16_t sx, ex, sy, ey;
             GetSelectingXY(sx, sy, ex, ey, cur_sx, cur_y, cur_ex, cur_y);
@@ -2082,17 +2711,8 @@ namespace Scene
 
     bool Scene::GetSelectedLines(size_t &start_y, size_t &end_y, size_t &start_x)
     {
-        auto first_displaying{
-            std::find_if(GetContentUiStart(),
-                         ui->end(),
-                         [](auto &item)
-                         { return item.displayable; })};
-
-        auto last_displaying{
-            std::find_if(first_displaying,
-                         ui->end(),
-                         [](auto &item)
-                         { return !item.displayable; })};
+        auto first_displaying{GetDisplayStart()};
+        auto last_displaying{first_displaying + GetDisplayedCount()};
 
         if (first_displaying == ui->end())
         {
@@ -2100,26 +2720,26 @@ namespace Scene
             return false;
         }
 
-        last_displaying--;
+        size_t first{viewport->first};
+        size_t last{first + (last_displaying - first_displaying) - 1};
 
-        auto ui_start{GetContentUiStart()};
         bool found_visible{
-            (selected.start_y <= (int)(last_displaying - ui_start) &&
-             selected.start_y >= (int)(first_displaying - ui_start)) ||
-            (selected.start_y < (int)(first_displaying - ui_start) &&
-             selected.end_y >= (int)(first_displaying - ui_start))};
+            (selected.start_y <= last &&
+             selected.start_y >= first) ||
+            (selected.start_y < first &&
+             selected.end_y >= first)};
 
         if (found_visible)
         {
-            start_x = selected.start_y < (int)(first_displaying - ui_start)
+            start_x = selected.start_y < first
                           ? 0
                           : selected.start_x;
-            start_y = selected.start_y < (int)(first_displaying - ui_start)
+            start_y = selected.start_y < first
                           ? 0
-                          : selected.start_y - (first_displaying - ui_start);
-            end_y = selected.end_y > (int)(last_displaying - ui_start)
-                        ? (last_displaying - ui_start + 1)
-                        : selected.end_y - (first_displaying - ui_start);
+                          : selected.start_y - first;
+            end_y = selected.end_y > last
+                        ? (last - first + 1)
+                        : selected.end_y - first;
         }
 
         return found_visible;
@@ -2150,7 +2770,12 @@ namespace Scene
             clipboard.is_file_copied = false;
             size_t ui_start_index{GetContentUiStartIndex(GetStage())};
 
-            if (selected.start_y == selected.end_y)
+            if (IsDocumentEditing())
+            {
+                size_t start{GetDocumentOffset(selected.start_y, selected.start_x)};
+                clipboard.data = text.Substr(start, GetDocumentOffset(selected.end_y, selected.end_x) - start);
+            }
+            else if (selected.start_y == selected.end_y)
             {
                 clipboard.data.append(
                     (*ui)[ui_start_index + selected.start_y].label,
@@ -2173,9 +2798,10 @@ namespace Scene
 
     void Scene::SelectAll(bool rerender)
     {
+        journal.Break();
         selected.start_x = selected.start_y = 0;
-        selected.end_y = ui->size() - 1 - GetContentUiStartIndex(GetStage());
-        selected.end_x = (*ui)[ui->size() - 1].label.length();
+        selected.end_y = GetContentRows() - 1;
+        selected.end_x = GetContentRowLength(selected.end_y);
         selected.is_selected = true;
 
         if (rerender)
@@ -2191,33 +2817,7 @@ namespace Scene
         if (selected.is_selected && IsCursorControlling())
         {
             Scene::Copy();
-
-            auto first_displaying{
-                std::find_if(GetContentUiStart(),
-                             ui->end(),
-                             [](auto &item)
-                             { return item.displayable; })};
-
-            if (first_displaying == ui->end())
-            {
-                ESP_LOGE(TAG, "First displaying not found");
-                return;
-            }
-
-            size_t first_displaying_index{static_cast<size_t>(first_displaying - GetContentUiStart())};
-
-            if (cursor.x != selected.end_x)
-            {
-                cursor.x = selected.end_x;
-            }
-
-            if (first_displaying_index + cursor.y != selected.end_y)
-            {
-                cursor.y = selected.end_y - first_displaying_index;
-            }
-
-            ResetSelecting(false);
-            CursorDeleteChars(clipboard.data.length(), GetLinesScroll());
+            DeleteSelected();
         }
     }
 }
\ No newline at end of file
@@ -13,11 +13,14 @@ namespace Scene
 
     static const char *theme_labels[]{"Default", "Light", "Green"};
 
+    static const char *pixel_format_labels[]{"16-bit (RGB565)", "12-bit (RGB444)"};
+
     enum SettingsSceneStage
     {
         SettingsStage,
         ThemeSettingsModalStage,
         FilesSortingModalStage,
+        PixelFormatModalStage,
     };
 
     SettingsScene::SettingsScene(DisplayController &display) : Scene{display} {}
@@ -90,6 +93,23 @@ namespace Scene
 
                 return SceneId::CurrentScene;
             }
+
+            if (IsStage(SettingsSceneStage::PixelFormatModalStage))
+            {
+                ESP_LOGD(TAG, "New pixel format: %s", focused->label.c_str());
+
+                for (size_t i{}; i < sizeof(pixel_format_labels) / sizeof(*pixel_format_labels); i++)
+                {
+                    if (focused->label.find(pixel_format_labels[i]) != std::string::npos)
+                    {
+                        Settings::Settings::SetPixelFormat((Settings::PixelFormats)i);
+                        display.SetPixelFormat((Settings::PixelFormats)i);
+                        break;
+                    }
+                }
+
+                return SceneId::CurrentScene;
+            }
         }
 
         if (focused->label.find("Theme") != std::string::npos)
@@ -100,6 +120,10 @@ namespace Scene
         {
             OpenStageModal(SettingsSceneStage::FilesSortingModalStage);
         }
+        else if (focused->label.find("Pixel Format") != std::string::npos)
+        {
+            OpenStageModal(SettingsSceneStage::PixelFormatModalStage);
+        }
 
         return SceneId::CurrentScene;
     }
@@ -108,6 +132,7 @@ namespace Scene
     {
         InitThemeSettingsModal();
         InitFilesSortingSettingsModal();
+        InitPixelFormatSettingsModal();
     }
 
     void SettingsScene::InitThemeSettingsModal()
@@ -182,6 +207,42 @@ namespace Scene
         AddStageModal((uint8_t)SettingsSceneStage::FilesSortingModalStage, modal);
     }
 
+    void SettingsScene::InitPixelFormatSettingsModal()
+    {
+        Modal modal{};
+        auto &theme{Settings::Settings::GetTheme()};
+
+        modal.ui.push_back(Display::UiStringItem{"Pixel Format", theme.Colors.MainTextColor, display.fx24G, false});
+        display.SetPosition(&modal.ui[0], Position::Center, Position::End);
+        modal.ui.push_back(Display::UiStringItem{"< Esc", theme.Colors.MainTextColor, display.fx24G});
+        display.SetPosition(&modal.ui[1], Position::Start, Position::End);
+
+        for (const char *pixel_format_label : pixel_format_labels)
+        {
+            modal.ui.push_back(Display::UiStringItem{pixel_format_label, theme.Colors.MainTextColor, display.fx24G});
+        }
+        display.SetListPositions(modal.ui.begin() + 2, modal.ui.end(), 10, display.GetHeight() - 60, 2);
+
+        modal.PreEnter = [this]()
+        {
+            Modal &modal{GetStageModal(SettingsSceneStage::PixelFormatModalStage)};
+            ChangeItemFocus(&modal.ui[2 + (int)Settings::Settings::GetPixelFormat()], true);
+        };
+
+        modal.PreLeave = [this]()
+        {
+            Modal &modal{GetStageModal(SettingsSceneStage::PixelFormatModalStage)};
+            auto focused{GetFocused(modal.ui.begin())};
+
+            if (focused != modal.ui.end())
+            {
+                ChangeItemFocus(&*focused, false);
+            }
+        };
+
+        AddStageModal((uint8_t)SettingsSceneStage::PixelFormatModalStage, modal);
+    }
+
     void SettingsScene::InitUI()
     {
         auto &theme{Settings::Settings::GetTheme()};
@@ -197,8 +258,11 @@ namespace Scene
             Display::UiStringItem{"Theme         ", theme.Colors.MainTextColor, display.fx24M});
         ui->push_back(
             Display::UiStringItem{"Files Sorting ", theme.Colors.MainTextColor, display.fx24M});
+        ui->push_back(
+            Display::UiStringItem{"Pixel Format  ", theme.Colors.MainTextColor, display.fx24M});
 
         ChangeItemFocus(&(*ui)[2], true);
+        ResetViewport();
     }
 
     void SettingsScene::SetTheme(Settings::Themes theme)
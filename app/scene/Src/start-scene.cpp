@@ -18,6 +18,7 @@ namespace Scene
             Display::UiStringItem{"> Settings  ", theme.Colors.MainTextColor, display.fx24G});
 
         ChangeItemFocus(&(*ui)[1], true);
+        ResetViewport();
         RenderAll();
     }
 
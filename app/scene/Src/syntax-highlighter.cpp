@@ -0,0 +1,412 @@
+#include "syntax-highlighter.h"
+
+#include <cctype>
+#include <algorithm>
+#include <string_view>
+
+namespace Scene
+{
+    constexpr uint16_t SYNTAX_UNKNOWN_STATE{0xFFFF};  // state to be lexed again, never matches a lexed one
+    constexpr uint16_t SYNTAX_OVERRUN_COMMENT{1 << 14}; // chars read past row end were comment, not string
+    constexpr size_t SYNTAX_MAX_LEVEL{30};            // deepest Lua long bracket level kept in state
+    constexpr size_t SYNTAX_MAX_WORD{64};             // word part looked up in rows next to lexed one
+
+    // Sorted for binary search
+    constexpr std::string_view LUA_KEYWORDS[]{
+        "and", "break", "do", "else", "elseif", "end", "false", "for", "function", "goto", "if",
+        "in", "local", "nil", "not", "or", "repeat", "return", "then", "true", "until", "while"};
+
+    constexpr std::string_view PYTHON_KEYWORDS[]{
+        "False", "None", "True", "and", "as", "assert", "async", "await", "break", "class",
+        "continue", "def", "del", "elif", "else", "except", "finally", "for", "from", "global",
+        "if", "import", "in", "is", "lambda", "nonlocal", "not", "or", "pass", "raise", "return",
+        "try", "while", "with", "yield"};
+
+    // Lexer state is kind in low 3 bits, Lua long bracket level in next 5 and
+    // count of next row chars already read by last token in 6 above them
+    enum LexKind : uint8_t
+    {
+        Code,
+        LineComment,
+        SingleQuoted,
+        DoubleQuoted,
+        TripleSingle,
+        TripleDouble,
+        LongString,
+        LongComment,
+    };
+
+    static bool isWordChar(char c)
+    {
+        return isalnum(static_cast<unsigned char>(c)) || c == '_';
+    }
+
+    bool SyntaxHighlighter::isKeyword(const TextBuffer &text, size_t start, size_t end) const
+    {
+        char word[16];
+        if (end - start >= sizeof(word))
+            return false;
+
+        text.Copy(start, end - start, word);
+        std::string_view view{word, end - start};
+
+        if (language == CodeLanguage::Lua)
+            return std::binary_search(std::begin(LUA_KEYWORDS), std::end(LUA_KEYWORDS), view);
+
+        return std::binary_search(std::begin(PYTHON_KEYWORDS), std::end(PYTHON_KEYWORDS), view);
+    }
+
+    // Lex row text [start, end) from state, returns state at start of next row.
+    // Tokens may be read past row ends, only their part inside row goes to runs.
+    // Chars of next row read by string or comment token are kept in state and
+    // skipped there, words are looked up again by next row instead.
+    uint16_t SyntaxHighlighter::lexRow(const TextBuffer &text, size_t start, size_t end, uint16_t state, std::vector<SyntaxRun> *runs) const
+    {
+        size_t size{text.Size()};
+        bool lua{language == CodeLanguage::Lua};
+        uint8_t kind{static_cast<uint8_t>(state & 7)};
+        size_t level{static_cast<size_t>(state >> 3 & 0x1F)};
+        size_t p{start + (state >> 8 & 0x3F)};
+        SyntaxToken last{state & SYNTAX_OVERRUN_COMMENT ? SyntaxToken::Comment : SyntaxToken::String};
+
+        auto at = [&text, size](size_t i)
+        {
+            return i < size ? text.At(i) : '\0';
+        };
+
+        auto emit = [runs, start, end, &last](size_t from, size_t to, SyntaxToken token)
+        {
+            last = token;
+            from = std::max(from, start);
+            to = std::min(to, end);
+            if (!runs || from >= to)
+                return;
+
+            if (!runs->empty() && runs->back().token == token)
+            {
+                runs->back().length += to - from;
+            }
+            else
+            {
+                runs->push_back(SyntaxRun{static_cast<uint8_t>(to - from), token});
+            }
+        };
+
+        // Level of Lua long bracket opening at i, or SIZE_MAX
+        auto opens = [&at](size_t i)
+        {
+            if (at(i) != '[')
+                return SIZE_MAX;
+
+            size_t count{};
+            while (at(i + 1 + count) == '=' && count <= SYNTAX_MAX_LEVEL)
+                count++;
+
+            return count <= SYNTAX_MAX_LEVEL && at(i + 1 + count) == '[' ? count : SIZE_MAX;
+        };
+
+        auto closes = [&at](size_t i, size_t level)
+        {
+            if (at(i) != ']' || at(i + level + 1) != ']')
+                return false;
+
+            for (size_t j = 1; j <= level; j++)
+            {
+                if (at(i + j) != '=')
+                    return false;
+            }
+
+            return true;
+        };
+
+        emit(start, p, last);
+
+        while (p < end)
+        {
+            size_t from{p};
+
+            switch (kind)
+            {
+            case LineComment:
+            {
+                while (p < end && at(p) != '\n')
+                    p++;
+
+                if (p < end)
+                {
+                    p++;
+                    kind = Code;
+                }
+
+                emit(from, p, SyntaxToken::Comment);
+                break;
+            }
+            case SingleQuoted:
+            case DoubleQuoted:
+            {
+                char quote{kind == SingleQuoted ? '\'' : '"'};
+                while (p < end)
+                {
+                    char c{at(p++)};
+                    if (c == '\\')
+                    {
+                        p++;
+                    }
+                    else if (c == quote || c == '\n')
+                    {
+                        kind = Code;
+                        break;
+                    }
+                }
+
+                emit(from, p, SyntaxToken::String);
+                break;
+            }
+            case TripleSingle:
+            case TripleDouble:
+            {
+                char quote{kind == TripleSingle ? '\'' : '"'};
+                while (p < end)
+                {
+                    char c{at(p)};
+                    if (c == '\\')
+                    {
+                        p += 2;
+                    }
+                    else if (c == quote && at(p + 1) == quote && at(p + 2) == quote)
+                    {
+                        p += 3;
+                        kind = Code;
+                        break;
+                    }
+                    else
+                    {
+                        p++;
+                    }
+                }
+
+                emit(from, p, SyntaxToken::String);
+                break;
+            }
+            case LongString:
+            case LongComment:
+            {
+                SyntaxToken token{kind == LongString ? SyntaxToken::String : SyntaxToken::Comment};
+                while (p < end)
+                {
+                    if (closes(p, level))
+                    {
+                        p += level + 2;
+                        kind = Code;
+                        level = 0;
+                        break;
+                    }
+                    p++;
+                }
+
+                emit(from, p, token);
+                break;
+            }
+            default:
+            {
+                char c{at(p)};
+                size_t opening{};
+
+                if (!lua && c == '#')
+                {
+                    kind = LineComment;
+                }
+                else if (lua && c == '-' && at(p + 1) == '-')
+                {
+                    kind = LineComment;
+                    opening = opens(p + 2);
+                    if (opening != SIZE_MAX)
+                    {
+                        p += opening + 4;
+                        kind = LongComment;
+                        level = opening;
+                        emit(from, p, SyntaxToken::Comment);
+                    }
+                }
+                else if (lua && (opening = opens(p)) != SIZE_MAX)
+                {
+                    p += opening + 2;
+                    kind = LongString;
+                    level = opening;
+                    emit(from, p, SyntaxToken::String);
+                }
+                else if (c == '\'' || c == '"')
+                {
+                    if (!lua && at(p + 1) == c && at(p + 2) == c)
+                    {
+                        p += 3;
+                        kind = c == '\'' ? TripleSingle : TripleDouble;
+                    }
+                    else
+                    {
+                        p++;
+                        kind = c == '\'' ? SingleQuoted : DoubleQuoted;
+                    }
+
+                    emit(from, p, SyntaxToken::String);
+                }
+                else if (c == '.' && isdigit(static_cast<unsigned char>(at(p + 1))))
+                {
+                    p++;
+                    while (p < end + SYNTAX_MAX_WORD && isWordChar(at(p)))
+                        p++;
+
+                    emit(from, p, SyntaxToken::Number);
+                    p = std::min(p, end);
+                }
+                else if (isWordChar(c))
+                {
+                    // Word wrapped from row above is looked up whole
+                    if (p == start)
+                    {
+                        while (from > 0 && start - from < SYNTAX_MAX_WORD && isWordChar(at(from - 1)))
+                            from--;
+                    }
+
+                    while (p < end + SYNTAX_MAX_WORD && isWordChar(at(p)))
+                        p++;
+
+                    SyntaxToken token{SyntaxToken::Text};
+                    if (isdigit(static_cast<unsigned char>(at(from))))
+                    {
+                        token = SyntaxToken::Number;
+                    }
+                    else if (isKeyword(text, from, p))
+                    {
+                        token = SyntaxToken::Keyword;
+                    }
+
+                    emit(from, p, token);
+                    p = std::min(p, end);
+                }
+                else
+                {
+                    p++;
+                    emit(from, p, SyntaxToken::Text);
+                }
+                break;
+            }
+            }
+        }
+
+        if (kind != LongString && kind != LongComment)
+        {
+            level = 0;
+        }
+
+        uint16_t next{static_cast<uint16_t>(kind | level << 3)};
+        if (p > end)
+        {
+            next |= (p - end) << 8;
+            if (last == SyntaxToken::Comment)
+            {
+                next |= SYNTAX_OVERRUN_COMMENT;
+            }
+        }
+
+        return next;
+    }
+
+    // Make states of rows before end right. Lexing stops early once a row
+    // gets the state cached for it: rows after it up to next unknown state
+    // were lexed from the same states and text before.
+    void SyntaxHighlighter::lex(const TextBuffer &text, const WrapIndex &wrap, size_t end)
+    {
+        end = std::min(end, states.size());
+
+        while (lexed < end)
+        {
+            size_t start{wrap.GetRowStart(lexed - 1)};
+            uint16_t state{lexRow(text, start, start + wrap.GetRowLength(lexed - 1), states[lexed - 1], nullptr)};
+
+            if (state == states[lexed])
+            {
+                lexed = std::find(states.begin() + lexed, states.end(), SYNTAX_UNKNOWN_STATE) - states.begin();
+            }
+            else
+            {
+                states[lexed++] = state;
+            }
+        }
+    }
+
+    void SyntaxHighlighter::SetLanguage(CodeLanguage language)
+    {
+        this->language = language;
+        states.clear();
+        lexed = 0;
+    }
+
+    bool SyntaxHighlighter::IsEnabled() const
+    {
+        return language == CodeLanguage::Lua || language == CodeLanguage::Python;
+    }
+
+    void SyntaxHighlighter::Build(size_t rows)
+    {
+        states.clear();
+        if (!IsEnabled() || !rows)
+            return;
+
+        states.assign(rows, SYNTAX_UNKNOWN_STATE);
+        states[0] = Code;
+        lexed = 1;
+    }
+
+    // Rows were replaced by wrap index update. States of new rows and of row
+    // after them are unknown, edited row's one is lexed again too, as row
+    // above may have read into it. Tokens end at a line break at latest and rows
+    // are longer than any token, so no row reads past the one below it.
+    void SyntaxHighlighter::Update(const WrapChange &change, size_t rows)
+    {
+        if (states.empty())
+            return;
+
+        size_t row{change.row};
+        size_t old_lexed{lexed};
+
+        size_t first{std::min(row + 1, states.size())};
+        size_t last{std::min(row + change.removed + 1, states.size())};
+        states.erase(states.begin() + first, states.begin() + last);
+
+        if (rows > states.size())
+        {
+            states.insert(states.begin() + first, rows - states.size(), SYNTAX_UNKNOWN_STATE);
+        }
+        states.resize(rows, SYNTAX_UNKNOWN_STATE);
+
+        if (old_lexed > row)
+        {
+            // Old lexed end isn't lexed from row above it
+            size_t shifted{old_lexed + change.inserted - change.removed};
+            if (old_lexed > row + change.removed && shifted < rows)
+            {
+                states[shifted] = SYNTAX_UNKNOWN_STATE;
+            }
+
+            lexed = std::max<size_t>(row, 1);
+        }
+        else if (row < rows)
+        {
+            states[row] = SYNTAX_UNKNOWN_STATE;
+        }
+    }
+
+    // Token runs of row, rows above it are lexed first when needed
+    void SyntaxHighlighter::GetRuns(const TextBuffer &text, const WrapIndex &wrap, size_t row, std::vector<SyntaxRun> &runs)
+    {
+        runs.clear();
+        if (row >= states.size())
+            return;
+
+        lex(text, wrap, row + 1);
+
+        size_t start{wrap.GetRowStart(row)};
+        lexRow(text, start, start + wrap.GetRowLength(row), states[row], &runs);
+    }
+}
@@ -0,0 +1,122 @@
+#include "text-buffer.h"
+
+#include <cstring>
+#include <algorithm>
+
+namespace Scene
+{
+    size_t TextBuffer::Size() const
+    {
+        return data.size() - (gap_end - gap_start);
+    }
+
+    char TextBuffer::At(size_t position) const
+    {
+        return position < gap_start ? data[position] : data[position + (gap_end - gap_start)];
+    }
+
+    // Move gap to start at position, text between old and new place goes to other side
+    void TextBuffer::moveGap(size_t position)
+    {
+        if (position < gap_start)
+        {
+            size_t count{gap_start - position};
+            memmove(&data[gap_end - count], &data[position], count);
+            gap_start -= count;
+            gap_end -= count;
+        }
+        else if (position > gap_start)
+        {
+            size_t count{position - gap_start};
+            memmove(&data[gap_start], &data[gap_end], count);
+            gap_start += count;
+            gap_end += count;
+        }
+    }
+
+    // Make gap fit count chars, buffer grows twice so inserts stay O(1) amortized
+    void TextBuffer::growGap(size_t count)
+    {
+        if (gap_end - gap_start >= count)
+            return;
+
+        size_t tail{data.size() - gap_end};
+        size_t size{std::max(data.size() * 2, Size() + count + 64)};
+
+        data.resize(size);
+        memmove(&data[size - tail], &data[gap_end], tail);
+        gap_end = size - tail;
+    }
+
+    void TextBuffer::Assign(const char *text, size_t count)
+    {
+        data.assign(text, text + count);
+        data.resize(count + 64);
+        gap_start = count;
+        gap_end = data.size();
+    }
+
+    void TextBuffer::Append(const char *text, size_t count)
+    {
+        Insert(Size(), text, count);
+    }
+
+    void TextBuffer::Insert(size_t position, const char *text, size_t count)
+    {
+        if (count == 0)
+            return;
+
+        position = std::min(position, Size());
+        moveGap(position);
+        growGap(count);
+        memcpy(&data[gap_start], text, count);
+        gap_start += count;
+    }
+
+    void TextBuffer::Erase(size_t position, size_t count)
+    {
+        if (position >= Size())
+            return;
+
+        count = std::min(count, Size() - position);
+        moveGap(position);
+        gap_end += count;
+    }
+
+    void TextBuffer::Clear()
+    {
+        gap_start = 0;
+        gap_end = data.size();
+    }
+
+    void TextBuffer::Copy(size_t position, size_t count, char *out) const
+    {
+        size_t end{std::min(position + count, Size())};
+        if (position >= end)
+            return;
+
+        // Part before gap, then part after it
+        if (position < gap_start)
+        {
+            size_t before{std::min(end, gap_start) - position};
+            memcpy(out, &data[position], before);
+            out += before;
+            position += before;
+        }
+
+        if (position < end)
+        {
+            memcpy(out, &data[position + (gap_end - gap_start)], end - position);
+        }
+    }
+
+    std::string TextBuffer::Substr(size_t position, size_t count) const
+    {
+        if (position >= Size())
+            return std::string{};
+
+        std::string text(std::min(count, Size() - position), '\0');
+        Copy(position, text.size(), text.data());
+        return text;
+    }
+}
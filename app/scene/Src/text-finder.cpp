@@ -0,0 +1,119 @@
+#include "text-finder.h"
+
+#include <algorithm>
+
+namespace Scene
+{
+    constexpr size_t FINDER_MAX_SKIP{UINT8_MAX}; // shorter shift is always safe, tables stay bytes
+
+    bool TextFinder::matches(const TextBuffer &text, size_t position) const
+    {
+        for (size_t i = 0; i < pattern.size(); i++)
+        {
+            if (text.At(position + i) != pattern[i])
+                return false;
+        }
+
+        return true;
+    }
+
+    // Build skip tables: distance from char's last place in pattern to its end,
+    // and from its first place to pattern start. Chars not in pattern skip it whole.
+    void TextFinder::SetPattern(const std::string &pattern)
+    {
+        this->pattern = pattern;
+        size_t size{pattern.size()};
+
+        std::fill(std::begin(skip), std::end(skip), std::min(size, FINDER_MAX_SKIP));
+        std::fill(std::begin(back_skip), std::end(back_skip), std::min(size, FINDER_MAX_SKIP));
+
+        for (size_t i = 0; i + 1 < size; i++)
+        {
+            skip[static_cast<uint8_t>(pattern[i])] = std::min(size - 1 - i, FINDER_MAX_SKIP);
+        }
+
+        for (size_t i = size; i-- > 1;)
+        {
+            back_skip[static_cast<uint8_t>(pattern[i])] = std::min(i, FINDER_MAX_SKIP);
+        }
+    }
+
+    const std::string &TextFinder::GetPattern() const
+    {
+        return pattern;
+    }
+
+    bool TextFinder::IsEmpty() const
+    {
+        return pattern.empty();
+    }
+
+    // First match starting at or after from
+    size_t TextFinder::FindNext(const TextBuffer &text, size_t from) const
+    {
+        size_t size{text.Size()}, length{pattern.size()};
+        if (!length)
+            return SIZE_MAX;
+
+        char last{pattern[length - 1]};
+        for (size_t position{from}; position + length <= size;)
+        {
+            char c{text.At(position + length - 1)};
+            if (c == last && matches(text, position))
+                return position;
+
+            position += skip[static_cast<uint8_t>(c)];
+        }
+
+        return SIZE_MAX;
+    }
+
+    // Last match ending at or before end
+    size_t TextFinder::FindPrev(const TextBuffer &text, size_t end) const
+    {
+        size_t length{pattern.size()};
+        end = std::min(end, text.Size());
+        if (!length || length > end)
+            return SIZE_MAX;
+
+        char first{pattern[0]};
+        for (size_t position{end - length};;)
+        {
+            char c{text.At(position)};
+            if (c == first && matches(text, position))
+                return position;
+
+            size_t shift{back_skip[static_cast<uint8_t>(c)]};
+            if (shift > position)
+                return SIZE_MAX;
+
+            position -= shift;
+        }
+    }
+
+    // Text from first match start to last match end with every match replaced,
+    // built in one pass. Returns count of matches, text is left unchanged.
+    size_t TextFinder::ReplaceAll(const TextBuffer &text, const std::string &replacement,
+                                  size_t &start, size_t &end, std::string &replaced) const
+    {
+        size_t count{}, copied{};
+        replaced.clear();
+
+        for (size_t match{FindNext(text, 0)}; match != SIZE_MAX; match = FindNext(text, match + pattern.size()))
+        {
+            if (!count++)
+            {
+                start = copied = match;
+            }
+
+            size_t kept{replaced.size()};
+            replaced.resize(kept + (match - copied));
+            text.Copy(copied, match - copied, replaced.data() + kept);
+            replaced += replacement;
+            copied = match + pattern.size();
+        }
+
+        end = copied;
+        return count;
+    }
+}
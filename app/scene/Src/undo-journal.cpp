@@ -0,0 +1,162 @@
+#include "undo-journal.h"
+
+#include <cstring>
+
+namespace Scene
+{
+    UndoJournal::UndoJournal(size_t budget) : budget{budget} {}
+
+    size_t UndoJournal::getUsed() const
+    {
+        return arena.size() - arena_first + records.size() * sizeof(Edit);
+    }
+
+    // Put single char edit into last record when it continues it: typed char
+    // after its inserted ones, backspace over them or over its removed ones
+    bool UndoJournal::merge(const TextBuffer &text, size_t offset, const char *chars, size_t inserted)
+    {
+        if (!merging || records.empty() || current != records.size())
+            return false;
+
+        Edit &last{records.back()};
+
+        if (inserted)
+        {
+            if (*chars == '\n' || offset != last.offset + last.inserted)
+                return false;
+
+            arena.push_back(*chars);
+            last.inserted++;
+            return true;
+        }
+
+        if (last.inserted && offset + 1 == last.offset + last.inserted)
+        {
+            arena.pop_back();
+            last.inserted--;
+
+            if (!last.removed && !last.inserted)
+            {
+                records.pop_back();
+                current--;
+            }
+            return true;
+        }
+
+        if (!last.inserted && offset + 1 == last.offset)
+        {
+            arena.insert(arena.begin() + last.text, text.At(offset));
+            last.offset = offset;
+            last.removed++;
+            return true;
+        }
+
+        return false;
+    }
+
+    // Drop oldest records until history fits budget
+    void UndoJournal::trim()
+    {
+        while (!records.empty() && getUsed() > budget)
+        {
+            records.pop_front();
+            if (current)
+                current--;
+        }
+
+        if (records.empty())
+        {
+            arena.clear();
+            arena_first = 0;
+            return;
+        }
+
+        // Move kept text to arena start once dropped text takes half of it
+        arena_first = records.front().text;
+        if (arena_first > arena.size() / 2)
+        {
+            arena.erase(arena.begin(), arena.begin() + arena_first);
+            for (Edit &edit : records)
+                edit.text -= arena_first;
+            arena_first = 0;
+        }
+    }
+
+    // Add edit replacing removed chars at offset with inserted chars, called
+    // before text buffer is changed. Records that could be redone are dropped.
+    void UndoJournal::Record(const TextBuffer &text, size_t offset, size_t removed, const char *chars, size_t inserted)
+    {
+        if (!removed && !inserted)
+            return;
+
+        if (removed + inserted == 1 && merge(text, offset, chars, inserted))
+        {
+            trim();
+            return;
+        }
+
+        if (current < records.size())
+        {
+            arena.resize(records[current].text);
+            records.erase(records.begin() + current, records.end());
+        }
+
+        // Edit doesn't fit, history before it can't be undone either
+        if (removed + inserted + sizeof(Edit) > budget)
+        {
+            Clear();
+            return;
+        }
+
+        size_t position{arena.size()};
+        arena.resize(position + removed + inserted);
+        text.Copy(offset, removed, arena.data() + position);
+        if (inserted)
+        {
+            memcpy(arena.data() + position + removed, chars, inserted);
+        }
+
+        records.push_back(Edit{offset, position, removed, inserted});
+        current = records.size();
+        merging = removed + inserted == 1;
+        trim();
+    }
+
+    bool UndoJournal::Undo(UndoStep &step)
+    {
+        if (!current)
+            return false;
+
+        const Edit &edit{records[--current]};
+        step = UndoStep{edit.offset, edit.inserted, arena.data() + edit.text, edit.removed};
+        merging = false;
+        return true;
+    }
+
+    bool UndoJournal::Redo(UndoStep &step)
+    {
+        if (current == records.size())
+            return false;
+
+        const Edit &edit{records[current++]};
+        step = UndoStep{edit.offset, edit.removed, arena.data() + edit.text + edit.removed, edit.inserted};
+        merging = false;
+        return true;
+    }
+
+    // Next edit starts its own record, called when cursor moves or selection changes
+    void UndoJournal::Break()
+    {
+        merging = false;
+    }
+
+    void UndoJournal::Clear()
+    {
+        records.clear();
+        arena.clear();
+        arena.shrink_to_fit();
+        arena_first = 0;
+        current = 0;
+        merging = false;
+    }
+}
@@ -0,0 +1,345 @@
+#include "wrap-index.h"
+
+#include <algorithm>
+
+namespace Scene
+{
+    constexpr size_t WRAP_CHUNK_ROWS{64};
+
+    void WrapIndex::buildTrees()
+    {
+        size_t count{chunks.size()};
+        rows_tree.assign(count + 1, 0);
+        chars_tree.assign(count + 1, 0);
+
+        for (size_t i = 1; i <= count; i++)
+        {
+            rows_tree[i] += chunks[i - 1].rows.size();
+            chars_tree[i] += chunks[i - 1].chars;
+
+            size_t parent{i + (i & (~i + 1))};
+            if (parent <= count)
+            {
+                rows_tree[parent] += rows_tree[i];
+                chars_tree[parent] += chars_tree[i];
+            }
+        }
+    }
+
+    void WrapIndex::addTrees(size_t chunk, int64_t rows, int64_t chars)
+    {
+        for (size_t i = chunk + 1; i < rows_tree.size(); i += i & (~i + 1))
+        {
+            rows_tree[i] += rows;
+            chars_tree[i] += chars;
+        }
+    }
+
+    // Rows in chunks before chunk
+    size_t WrapIndex::prefixRows(size_t chunk) const
+    {
+        size_t sum{};
+        for (size_t i = chunk; i > 0; i -= i & (~i + 1))
+        {
+            sum += rows_tree[i];
+        }
+
+        return sum;
+    }
+
+    // Chars in chunks before chunk
+    size_t WrapIndex::prefixChars(size_t chunk) const
+    {
+        size_t sum{};
+        for (size_t i = chunk; i > 0; i -= i & (~i + 1))
+        {
+            sum += chars_tree[i];
+        }
+
+        return sum;
+    }
+
+    WrapIndex::Position WrapIndex::findRow(size_t row) const
+    {
+        size_t count{chunks.size()};
+        if (row >= rows_count)
+        {
+            return Position{count - 1, chunks[count - 1].rows.size()};
+        }
+
+        size_t step{1}, chunk{};
+        while (step * 2 <= count)
+            step *= 2;
+
+        // Skip whole chunks, chunks are never empty
+        for (; step; step /= 2)
+        {
+            if (chunk + step <= count && rows_tree[chunk + step] <= row)
+            {
+                chunk += step;
+                row -= rows_tree[chunk];
+            }
+        }
+
+        return Position{chunk, row};
+    }
+
+    WrapIndex::Position WrapIndex::findOffset(size_t offset, size_t *start) const
+    {
+        size_t count{chunks.size()};
+        if (offset >= chars_count)
+        {
+            *start = chars_count - chunks[count - 1].rows.back();
+            return Position{count - 1, chunks[count - 1].rows.size() - 1};
+        }
+
+        size_t step{1}, chunk{};
+        while (step * 2 <= count)
+            step *= 2;
+
+        *start = 0;
+        for (; step; step /= 2)
+        {
+            if (chunk + step <= count && chars_tree[chunk + step] <= offset)
+            {
+                chunk += step;
+                offset -= chars_tree[chunk];
+                *start += chars_tree[chunk];
+            }
+        }
+
+        const std::vector<uint8_t> &rows{chunks[chunk].rows};
+        size_t index{};
+        while (offset >= rows[index])
+        {
+            offset -= rows[index];
+            *start += rows[index];
+            index++;
+        }
+
+        return Position{chunk, index};
+    }
+
+    // Length of row starting at offset
+    uint8_t WrapIndex::wrapRow(const TextBuffer &text, size_t offset) const
+    {
+        size_t size{text.Size()};
+        uint8_t length{};
+
+        while (offset + length < size && length < line_length)
+        {
+            if (text.At(offset + length++) == '\n')
+                break;
+        }
+
+        return length;
+    }
+
+    // Put rows in place of count rows from row, rebuilding touched chunks
+    void WrapIndex::replaceRows(size_t row, size_t count, const std::vector<uint8_t> &rows)
+    {
+        Position first{findRow(row)};
+        Position end{findRow(row + count)};
+        size_t last_chunk{std::min(end.chunk, chunks.size() - 1)};
+
+        std::vector<uint8_t> merged(chunks[first.chunk].rows.begin(), chunks[first.chunk].rows.begin() + first.index);
+        merged.insert(merged.end(), rows.begin(), rows.end());
+        merged.insert(merged.end(), chunks[last_chunk].rows.begin() + end.index, chunks[last_chunk].rows.end());
+
+        // Absorb next chunk when it's left small
+        if (merged.size() < WRAP_CHUNK_ROWS / 4 && last_chunk + 1 < chunks.size())
+        {
+            last_chunk++;
+            merged.insert(merged.end(), chunks[last_chunk].rows.begin(), chunks[last_chunk].rows.end());
+        }
+
+        size_t pieces{(merged.size() + WRAP_CHUNK_ROWS - 1) / WRAP_CHUNK_ROWS};
+        std::vector<Chunk> parts(pieces);
+        for (size_t i = 0, from = 0; i < pieces; i++)
+        {
+            size_t to{merged.size() * (i + 1) / pieces};
+            parts[i].rows.assign(merged.begin() + from, merged.begin() + to);
+            for (uint8_t length : parts[i].rows)
+                parts[i].chars += length;
+            from = to;
+        }
+
+        size_t replaced{last_chunk - first.chunk + 1};
+        for (size_t i = first.chunk; i <= last_chunk; i++)
+        {
+            rows_count -= chunks[i].rows.size();
+            chars_count -= chunks[i].chars;
+        }
+        for (const Chunk &part : parts)
+        {
+            rows_count += part.rows.size();
+            chars_count += part.chars;
+        }
+
+        if (replaced == pieces)
+        {
+            for (size_t i = 0; i < pieces; i++)
+            {
+                Chunk &chunk{chunks[first.chunk + i]};
+                addTrees(first.chunk + i,
+                         (int64_t)parts[i].rows.size() - (int64_t)chunk.rows.size(),
+                         (int64_t)parts[i].chars - (int64_t)chunk.chars);
+                chunk = std::move(parts[i]);
+            }
+            return;
+        }
+
+        chunks.erase(chunks.begin() + first.chunk, chunks.begin() + last_chunk + 1);
+        chunks.insert(chunks.begin() + first.chunk,
+                      std::make_move_iterator(parts.begin()),
+                      std::make_move_iterator(parts.end()));
+        buildTrees();
+    }
+
+    void WrapIndex::Build(const TextBuffer &text, size_t line_length)
+    {
+        this->line_length = std::clamp<size_t>(line_length, 1, UINT8_MAX);
+        chunks.clear();
+        rows_count = 0;
+        chars_count = 0;
+
+        size_t size{text.Size()}, offset{};
+        Chunk chunk{};
+        uint8_t length{};
+
+        do
+        {
+            length = wrapRow(text, offset);
+            offset += length;
+
+            chunk.rows.push_back(length);
+            chunk.chars += length;
+            if (chunk.rows.size() == WRAP_CHUNK_ROWS)
+            {
+                rows_count += chunk.rows.size();
+                chars_count += chunk.chars;
+                chunks.push_back(std::move(chunk));
+                chunk = Chunk{};
+            }
+        } while (offset < size);
+
+        // Keep last row open for typing
+        if (length == this->line_length || (length && text.At(offset - 1) == '\n'))
+        {
+            chunk.rows.push_back(0);
+        }
+
+        if (!chunk.rows.empty())
+        {
+            rows_count += chunk.rows.size();
+            chars_count += chunk.chars;
+            chunks.push_back(std::move(chunk));
+        }
+
+        buildTrees();
+    }
+
+    // Text at offset had removed chars replaced by inserted ones. Rows before
+    // the edited row keep their breaks, rows are rewrapped from it until a new
+    // break past the edit meets an old one, rest of rows only shift.
+    WrapChange WrapIndex::Update(const TextBuffer &text, size_t offset, size_t removed, size_t inserted)
+    {
+        if (chunks.empty())
+        {
+            Build(text, line_length);
+            return WrapChange{0, 0, rows_count};
+        }
+
+        size_t size{text.Size()};
+        size_t start{};
+        Position old_row{findOffset(offset, &start)};
+        size_t first_row{prefixRows(old_row.chunk) + old_row.index};
+
+        size_t old_end{start}, old_rows{};
+        std::vector<uint8_t> rows{};
+        size_t position{start};
+        uint8_t length{};
+
+        while (true)
+        {
+            length = wrapRow(text, position);
+            position += length;
+            rows.push_back(length);
+
+            if (position >= size)
+                break;
+
+            if (position < offset + inserted)
+                continue;
+
+            // Break in old text coordinates
+            size_t old_break{position - inserted + removed};
+            while (old_end < old_break && old_row.chunk < chunks.size())
+            {
+                old_end += chunks[old_row.chunk].rows[old_row.index];
+                old_rows++;
+                if (++old_row.index == chunks[old_row.chunk].rows.size())
+                {
+                    old_row.chunk++;
+                    old_row.index = 0;
+                }
+            }
+
+            if (old_end == old_break)
+            {
+                replaceRows(first_row, old_rows, rows);
+                return WrapChange{first_row, old_rows, rows.size()};
+            }
+        }
+
+        if (length == line_length || (length && text.At(position - 1) == '\n'))
+        {
+            rows.push_back(0);
+        }
+
+        old_rows = rows_count - first_row;
+        replaceRows(first_row, old_rows, rows);
+        return WrapChange{first_row, old_rows, rows.size()};
+    }
+
+    size_t WrapIndex::GetRows() const
+    {
+        return rows_count;
+    }
+
+    size_t WrapIndex::GetLineLength() const
+    {
+        return line_length;
+    }
+
+    size_t WrapIndex::GetRowStart(size_t row) const
+    {
+        Position position{findRow(row)};
+        const std::vector<uint8_t> &rows{chunks[position.chunk].rows};
+
+        size_t start{prefixChars(position.chunk)};
+        for (size_t i = 0; i < position.index; i++)
+        {
+            start += rows[i];
+        }
+
+        return start;
+    }
+
+    size_t WrapIndex::GetRowLength(size_t row) const
+    {
+        if (row >= rows_count)
+            return 0;
+
+        Position position{findRow(row)};
+        return chunks[position.chunk].rows[position.index];
+    }
+
+    // Row holding offset, text end belongs to last row
+    size_t WrapIndex::GetRow(size_t offset) const
+    {
+        size_t start{};
+        Position position{findOffset(offset, &start)};
+        return prefixRows(position.chunk) + position.index;
+    }
+}
@@ -72,6 +72,34 @@ namespace SD
         return result;
     }
 
+    // Read whole file opened once, on_read gets it block by block
+    esp_err_t SDCard::ReadFile(const char *path, const std::function<void(const char *, size_t)> &on_read)
+    {
+        FILE *file = fopen(path, "r");
+        if (file == NULL)
+        {
+            ESP_LOGE(TAG, "Failed to open file \"%s\"", path);
+            return ESP_FAIL;
+        }
+
+        char buff[512];
+        size_t read{};
+        while ((read = fread(buff, 1, sizeof(buff), file)) > 0)
+        {
+            on_read(buff, read);
+        }
+
+        bool failed{ferror(file) != 0};
+        fclose(file);
+        if (failed)
+        {
+            ESP_LOGE(TAG, "Failed to read file \"%s\"", path);
+            return ESP_FAIL;
+        }
+
+        return ESP_OK;
+    }
+
     esp_err_t SDCard::WriteFile(
         const char *path,
         const char *buff,
@@ -297,6 +325,20 @@ namespace SD
         return ESP_OK;
     }
 
+    esp_err_t SDCard::GetFileSize(const char *path, size_t &size)
+    {
+        std::error_code ec{};
+        uintmax_t file_size{std::filesystem::file_size(path, ec)};
+        if (ec)
+        {
+            ESP_LOGE(TAG, "Failed to get size of file \"%s\"", path);
+            return ESP_FAIL;
+        }
+
+        size = file_size;
+        return ESP_OK;
+    }
+
     bool SDCard::Exists(const char *path)
     {
         std::error_code ec{};
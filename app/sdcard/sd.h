@@ -5,6 +5,7 @@
 #include <vector>
 #include <filesystem>
 #include <fstream>
+#include <functional>
 
 #include "esp_log.h"
 #include "driver/spi_master.h"
@@ -31,6 +32,7 @@ namespace SD
         esp_err_t Unmount();
 
         size_t ReadFile(const char *path, char *buff, size_t len, uint32_t pos = 0, uint8_t seek_point = SEEK_SET);
+        esp_err_t ReadFile(const char *path, const std::function<void(const char *, size_t)> &on_read);
         esp_err_t WriteFile(const char *path, const char *buff, uint32_t pos = 0, std::ios_base::seekdir seek_point = std::ios_base::beg, std::ios_base::openmode = std::ios::out);
         esp_err_t ReadDirectory(const char *path, std::vector<std::string> &files);
 
@@ -41,6 +43,7 @@ namespace SD
         esp_err_t RenameFile(const char *path, const char *new_path);
         esp_err_t CopyFile(const char *path, const char *new_path);
 
+        esp_err_t GetFileSize(const char *path, size_t &size);
         bool Exists(const char *path);
         bool IsDirectory(const char *path);
     };
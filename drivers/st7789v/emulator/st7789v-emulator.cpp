@@ -0,0 +1,388 @@
+#include <string.h>
+#include <stdio.h>
+#include <inttypes.h>
+#include <deque>
+
+#include "esp_log.h"
+
+#include "driver/spi_master.h"
+#include "driver/gpio.h"
+#include "st7789v-emulator.h"
+
+static const char *TAG = "ST7789V-EMU";
+
+namespace LCD::Emulator
+{
+    typedef struct
+    {
+        uint16_t memory[PANEL_WIDTH * PANEL_HEIGHT]; // row by row, as addressed by CASET/RASET
+        uint8_t command;
+        uint8_t args[6];
+        uint8_t arg_count;
+        bool writing;       // RAMWR data follows
+        uint8_t pixel_high; // first byte of pixel split between transfers
+        bool pixel_pending;
+        uint32_t nibbles;       // RGB444 bits not yet forming a pixel
+        uint8_t nibble_count;
+        uint16_t xs, xe, ys, ye;
+        uint16_t x, y;
+        uint8_t madctl;
+        uint8_t colmod;
+        bool inverted;
+        bool display_on;
+        uint16_t tfa, vsa, bfa; // vertical scrolling definition
+        uint16_t vsp;           // vertical scroll start address
+    } PANEL_t;
+
+    static PANEL_t panel;
+    static gpio_num_t dc_gpio = GPIO_NUM_NC;
+    static EMULATOR_STATS_t stats, frame_stats;
+
+    static void write_pixel(uint16_t color)
+    {
+        if (panel.x < PANEL_WIDTH && panel.y < PANEL_HEIGHT)
+        {
+            panel.memory[panel.y * PANEL_WIDTH + panel.x] = color;
+        }
+        stats.pixels++;
+
+        if (panel.x++ >= panel.xe)
+        {
+            panel.x = panel.xs;
+            if (panel.y++ >= panel.ye)
+            {
+                panel.y = panel.ys;
+            }
+        }
+    }
+
+    static void apply_args()
+    {
+        const uint8_t *a = panel.args;
+
+        switch (panel.command)
+        {
+        case 0x2A: // Column Address Set
+            if (panel.arg_count == 4)
+            {
+                panel.xs = (a[0] << 8) | a[1];
+                panel.xe = (a[2] << 8) | a[3];
+            }
+            break;
+        case 0x2B: // Row Address Set
+            if (panel.arg_count == 4)
+            {
+                panel.ys = (a[0] << 8) | a[1];
+                panel.ye = (a[2] << 8) | a[3];
+            }
+            break;
+        case 0x33: // Vertical Scrolling Definition
+            if (panel.arg_count == 6)
+            {
+                panel.tfa = (a[0] << 8) | a[1];
+                panel.vsa = (a[2] << 8) | a[3];
+                panel.bfa = (a[4] << 8) | a[5];
+            }
+            break;
+        case 0x36: // Memory Data Access Control
+            panel.madctl = a[0];
+            break;
+        case 0x37: // Vertical Scroll Start Address
+            if (panel.arg_count == 2)
+            {
+                panel.vsp = (a[0] << 8) | a[1];
+            }
+            break;
+        case 0x3A: // Interface Pixel Format
+            panel.colmod = a[0];
+            if ((panel.colmod & 0x07) != 0x05 && (panel.colmod & 0x07) != 0x03)
+            {
+                ESP_LOGW(TAG, "Pixel format 0x%02X is not emulated, pixels are taken as RGB565", panel.colmod);
+            }
+            break;
+        }
+    }
+
+    static void command(uint8_t cmd)
+    {
+        stats.commands++;
+        panel.command = cmd;
+        panel.arg_count = 0;
+        panel.writing = false;
+        panel.pixel_pending = false;
+        panel.nibble_count = 0;
+
+        switch (cmd)
+        {
+        case 0x01: // Software Reset
+            Reset();
+            break;
+        case 0x20: // Display Inversion Off
+            panel.inverted = false;
+            break;
+        case 0x21: // Display Inversion On
+            panel.inverted = true;
+            break;
+        case 0x28: // Display Off
+            panel.display_on = false;
+            break;
+        case 0x29: // Display On
+            panel.display_on = true;
+            break;
+        case 0x2C: // Memory Write
+            panel.writing = true;
+            panel.x = panel.xs;
+            panel.y = panel.ys;
+            break;
+        }
+    }
+
+    static void data(const uint8_t *bytes, size_t length)
+    {
+        size_t i = 0;
+
+        if (!panel.writing)
+        {
+            for (; i < length; i++)
+            {
+                if (panel.arg_count < sizeof(panel.args))
+                {
+                    panel.args[panel.arg_count++] = bytes[i];
+                }
+                apply_args();
+            }
+            return;
+        }
+
+        if ((panel.colmod & 0x07) == 0x03)
+        {
+            // 12 bits per pixel, stored as RGB565 with low bits filled from high
+            for (; i < length; i++)
+            {
+                panel.nibbles = (panel.nibbles << 8) | bytes[i];
+                panel.nibble_count += 2;
+                if (panel.nibble_count >= 3)
+                {
+                    panel.nibble_count -= 3;
+                    uint16_t c = (panel.nibbles >> (panel.nibble_count * 4)) & 0x0FFF;
+                    uint16_t r = (c >> 8) & 0x0F, g = (c >> 4) & 0x0F, b = c & 0x0F;
+                    write_pixel(((r << 1 | r >> 3) << 11) | ((g << 2 | g >> 2) << 5) | (b << 1 | b >> 3));
+                }
+            }
+            return;
+        }
+
+        if (panel.pixel_pending && length > 0)
+        {
+            write_pixel((panel.pixel_high << 8) | bytes[i++]);
+            panel.pixel_pending = false;
+        }
+
+        for (; i + 1 < length; i += 2)
+        {
+            write_pixel((bytes[i] << 8) | bytes[i + 1]);
+        }
+
+        if (i < length)
+        {
+            panel.pixel_high = bytes[i];
+            panel.pixel_pending = true;
+        }
+    }
+
+    // Decode one transfer, DC line level tells command from data
+    static void transfer(const uint8_t *bytes, size_t length)
+    {
+        stats.transactions++;
+        stats.bytes += length;
+
+        if (gpio_get_level(dc_gpio) == 0)
+        {
+            for (size_t i = 0; i < length; i++)
+            {
+                command(bytes[i]);
+            }
+        }
+        else
+        {
+            data(bytes, length);
+        }
+    }
+
+    // Decode transfers with level of dc line
+    void AttachPanel(gpio_num_t dc)
+    {
+        dc_gpio = dc;
+        Reset();
+    }
+
+    void Reset()
+    {
+        memset(&panel, 0, sizeof(panel));
+        panel.xe = PANEL_WIDTH - 1;
+        panel.ye = PANEL_HEIGHT - 1;
+        panel.vsa = PANEL_HEIGHT;
+        panel.colmod = 0x66;
+    }
+
+    const uint16_t *GetMemory()
+    {
+        return panel.memory;
+    }
+
+    // Pixel as seen on the screen, with mirroring, scrolling and inversion applied
+    // Display off shows black.
+    uint16_t GetPixel(uint16_t x, uint16_t y)
+    {
+        if (x >= PANEL_WIDTH || y >= PANEL_HEIGHT || !panel.display_on)
+            return 0;
+
+        uint16_t column = (panel.madctl & 0x40) ? PANEL_WIDTH - 1 - x : x;
+        uint16_t row = (panel.madctl & 0x80) ? PANEL_HEIGHT - 1 - y : y;
+
+        if (panel.vsa > 0 && row >= panel.tfa && row < panel.tfa + panel.vsa)
+        {
+            row = panel.tfa + (row - panel.tfa + panel.vsp - panel.tfa + panel.vsa) % panel.vsa;
+        }
+
+        uint16_t color = panel.memory[row * PANEL_WIDTH + column];
+        return panel.inverted ? ~color : color;
+    }
+
+    // Save screen as binary PPM
+    bool DumpPPM(const char *path)
+    {
+        FILE *file = fopen(path, "wb");
+        if (file == NULL)
+        {
+            ESP_LOGE(TAG, "Can't open %s", path);
+            return false;
+        }
+
+        fprintf(file, "P6\n%d %d\n255\n", PANEL_WIDTH, PANEL_HEIGHT);
+
+        uint8_t line[PANEL_WIDTH * 3];
+        for (uint16_t y = 0; y < PANEL_HEIGHT; y++)
+        {
+            for (uint16_t x = 0; x < PANEL_WIDTH; x++)
+            {
+                uint16_t color = GetPixel(x, y);
+                uint8_t r = (color >> 11) & 0x1F, g = (color >> 5) & 0x3F, b = color & 0x1F;
+
+                line[x * 3] = (r << 3) | (r >> 2);
+                line[x * 3 + 1] = (g << 2) | (g >> 4);
+                line[x * 3 + 2] = (b << 3) | (b >> 2);
+            }
+            fwrite(line, 1, sizeof(line), file);
+        }
+
+        fclose(file);
+        return true;
+    }
+
+    EMULATOR_STATS_t GetStats()
+    {
+        return stats;
+    }
+
+    // Get counters since last EndFrame call
+    EMULATOR_STATS_t EndFrame()
+    {
+        EMULATOR_STATS_t frame{
+            .transactions = stats.transactions - frame_stats.transactions,
+            .commands = stats.commands - frame_stats.commands,
+            .bytes = stats.bytes - frame_stats.bytes,
+            .pixels = stats.pixels - frame_stats.pixels,
+        };
+
+        frame_stats = stats;
+        ESP_LOGD(TAG, "Frame: %" PRIu32 " transactions, %" PRIu32 " commands, %" PRIu32 " bytes, %" PRIu32 " pixels",
+                 frame.transactions, frame.commands, frame.bytes, frame.pixels);
+        return frame;
+    }
+}
+
+// SPI master and GPIO driver functions, transfers complete at once
+
+struct spi_device_t
+{
+    spi_device_interface_config_t config;
+    std::deque<spi_transaction_t *> done;
+};
+
+static spi_device_t spi_device;
+static uint32_t gpio_levels[GPIO_NUM_MAX];
+
+esp_err_t spi_bus_initialize(spi_host_device_t host_id, const spi_bus_config_t *bus_config, spi_dma_chan_t dma_chan)
+{
+    return ESP_OK;
+}
+
+esp_err_t spi_bus_add_device(spi_host_device_t host_id, const spi_device_interface_config_t *dev_config, spi_device_handle_t *handle)
+{
+    spi_device.config = *dev_config;
+    spi_device.done.clear();
+    *handle = &spi_device;
+    return ESP_OK;
+}
+
+esp_err_t spi_device_queue_trans(spi_device_handle_t handle, spi_transaction_t *trans_desc, uint32_t ticks_to_wait)
+{
+    if ((int)handle->done.size() >= handle->config.queue_size)
+        return ESP_ERR_TIMEOUT;
+
+    if (handle->config.pre_cb)
+    {
+        handle->config.pre_cb(trans_desc);
+    }
+
+    const uint8_t *bytes = (trans_desc->flags & SPI_TRANS_USE_TXDATA)
+                               ? trans_desc->tx_data
+                               : (const uint8_t *)trans_desc->tx_buffer;
+    LCD::Emulator::transfer(bytes, trans_desc->length / 8);
+
+    if (handle->config.post_cb)
+    {
+        handle->config.post_cb(trans_desc);
+    }
+
+    handle->done.push_back(trans_desc);
+    return ESP_OK;
+}
+
+esp_err_t spi_device_get_trans_result(spi_device_handle_t handle, spi_transaction_t **trans_desc, uint32_t ticks_to_wait)
+{
+    if (handle->done.empty())
+        return ESP_ERR_TIMEOUT;
+
+    *trans_desc = handle->done.front();
+    handle->done.pop_front();
+    return ESP_OK;
+}
+
+esp_err_t gpio_reset_pin(gpio_num_t gpio_num)
+{
+    return gpio_set_level(gpio_num, 0);
+}
+
+esp_err_t gpio_set_direction(gpio_num_t gpio_num, gpio_mode_t mode)
+{
+    return ESP_OK;
+}
+
+esp_err_t gpio_set_level(gpio_num_t gpio_num, uint32_t level)
+{
+    if (gpio_num < 0 || gpio_num >= GPIO_NUM_MAX)
+        return ESP_ERR_INVALID_ARG;
+
+    gpio_levels[gpio_num] = level;
+    return ESP_OK;
+}
+
+int gpio_get_level(gpio_num_t gpio_num)
+{
+    if (gpio_num < 0 || gpio_num >= GPIO_NUM_MAX)
+        return 0;
+
+    return gpio_levels[gpio_num];
+}
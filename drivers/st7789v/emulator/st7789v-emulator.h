@@ -0,0 +1,34 @@
+#pragma once
+// ST7789V panel emulator for host (linux target) builds
+// SPI transfers queued by the driver are decoded into panel memory, so
+// rendering can be checked and measured without the board. Host tests in
+// test/host compare its screen with golden frames.
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "driver/gpio.h"
+
+namespace LCD::Emulator
+{
+    constexpr uint16_t PANEL_WIDTH = 240;
+    constexpr uint16_t PANEL_HEIGHT = 320;
+
+    typedef struct
+    {
+        uint32_t transactions;
+        uint32_t commands;
+        uint32_t bytes;
+        uint32_t pixels;
+    } EMULATOR_STATS_t;
+
+    void AttachPanel(gpio_num_t dc);
+    void Reset();
+
+    const uint16_t *GetMemory();
+    uint16_t GetPixel(uint16_t x, uint16_t y);
+    bool DumpPPM(const char *path);
+
+    EMULATOR_STATS_t GetStats();
+    EMULATOR_STATS_t EndFrame();
+}
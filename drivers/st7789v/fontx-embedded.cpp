@@ -0,0 +1,50 @@
+#include <string.h>
+
+#include "fontx-embedded.h"
+
+// Fonts from fonts directory, linked by EMBED_FILES
+#if CONFIG_FONTX_EMBEDDED
+extern const uint8_t ILGH16XB_start[] asm("_binary_ILGH16XB_FNT_start");
+extern const uint8_t ILGH16XB_end[] asm("_binary_ILGH16XB_FNT_end");
+extern const uint8_t ILGH24XB_start[] asm("_binary_ILGH24XB_FNT_start");
+extern const uint8_t ILGH24XB_end[] asm("_binary_ILGH24XB_FNT_end");
+extern const uint8_t ILGH32XB_start[] asm("_binary_ILGH32XB_FNT_start");
+extern const uint8_t ILGH32XB_end[] asm("_binary_ILGH32XB_FNT_end");
+extern const uint8_t LATIN32B_start[] asm("_binary_LATIN32B_FNT_start");
+extern const uint8_t LATIN32B_end[] asm("_binary_LATIN32B_FNT_end");
+extern const uint8_t ILMH16XB_start[] asm("_binary_ILMH16XB_FNT_start");
+extern const uint8_t ILMH16XB_end[] asm("_binary_ILMH16XB_FNT_end");
+extern const uint8_t ILMH24XB_start[] asm("_binary_ILMH24XB_FNT_start");
+extern const uint8_t ILMH24XB_end[] asm("_binary_ILMH24XB_FNT_end");
+extern const uint8_t ILMH32XB_start[] asm("_binary_ILMH32XB_FNT_start");
+extern const uint8_t ILMH32XB_end[] asm("_binary_ILMH32XB_FNT_end");
+
+static const Fontx::FontxEmbedded embedded_fonts[]{
+    {"ILGH16XB.FNT", ILGH16XB_start, ILGH16XB_end},
+    {"ILGH24XB.FNT", ILGH24XB_start, ILGH24XB_end},
+    {"ILGH32XB.FNT", ILGH32XB_start, ILGH32XB_end},
+    {"LATIN32B.FNT", LATIN32B_start, LATIN32B_end},
+    {"ILMH16XB.FNT", ILMH16XB_start, ILMH16XB_end},
+    {"ILMH24XB.FNT", ILMH24XB_start, ILMH24XB_end},
+    {"ILMH32XB.FNT", ILMH32XB_start, ILMH32XB_end},
+};
+#endif
+
+namespace Fontx
+{
+    const FontxEmbedded *FindEmbeddedFontx(const char *name)
+    {
+#if CONFIG_FONTX_EMBEDDED
+        const char *slash = strrchr(name, '/');
+        if (slash != NULL)
+            name = slash + 1;
+
+        for (const FontxEmbedded &font : embedded_fonts)
+        {
+            if (strcmp(font.name, name) == 0)
+                return &font;
+        }
+#endif
+        return NULL;
+    }
+}
@@ -0,0 +1,20 @@
+#ifndef MAIN_FONTX_EMBEDDED_H_
+#define MAIN_FONTX_EMBEDDED_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include "sdkconfig.h"
+
+namespace Fontx
+{
+    typedef struct
+    {
+        const char *name; // file name in fonts directory
+        const uint8_t *start;
+        const uint8_t *end;
+    } FontxEmbedded;
+
+    // Find font linked into flash by its file name, NULL when not embedded
+    const FontxEmbedded *FindEmbeddedFontx(const char *name);
+}
+#endif /* MAIN_FONTX_EMBEDDED_H_ */
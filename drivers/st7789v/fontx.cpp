@@ -21,12 +21,37 @@ namespace Fontx
         fx->opened = false;
     }
 
+    // Set font linked into flash in FontxFile structure, name is for logs
+    void Font::AddEmbeddedFontx(FontxFile *fx, const char *name, const uint8_t *start, const uint8_t *end)
+    {
+        memset(fx, 0, sizeof(FontxFile));
+        fx->path = name;
+        fx->data = start;
+        fx->data_size = end - start;
+        fx->opened = false;
+    }
+
     // Initialize FontxFile structure
     // フォント構造体を初期化
     void Font::InitFontx(FontxFile *fxs, const char *f0, const char *f1)
     {
         AddFontx(&fxs[0], f0);
         AddFontx(&fxs[1], f1);
+
+        // Load glyphs now, so drawing never waits on the filesystem
+        for (int i = 0; i < 2; i++)
+        {
+            if (fxs[i].path != NULL && fxs[i].path[0] != '\0')
+                OpenFontx(&fxs[i]);
+        }
+    }
+
+    // Initialize FontxFile structure with font linked into flash
+    void Font::InitEmbeddedFontx(FontxFile *fxs, const char *name, const uint8_t *start, const uint8_t *end)
+    {
+        AddEmbeddedFontx(&fxs[0], name, start, end);
+        AddFontx(&fxs[1], "");
+        OpenFontx(&fxs[0]);
     }
 
     // Open font file
@@ -36,35 +61,50 @@ namespace Fontx
         FILE *f;
         if (!fx->opened)
         {
-            if (FontxDebug)
-                printf("[openFont]fx->path=[%s]\n", fx->path);
-            f = fopen(fx->path, "r");
-            if (FontxDebug)
-                printf("[openFont]fopen=%p\n", f);
-            if (f == NULL)
+            char buf[18];
+
+            // Embedded font, header and glyphs are read in place
+            if (fx->data != NULL)
             {
-                fx->valid = false;
-                printf("Fontx:%s not found.\n", fx->path);
-                return fx->valid;
+                if (fx->data_size < sizeof(buf))
+                {
+                    printf("Fontx:%s not FONTX format.\n", fx->path);
+                    fx->valid = false;
+                    return fx->valid;
+                }
+                memcpy(buf, fx->data, sizeof(buf));
             }
-
-            // Read fontx header
-            fx->file = f;
-            char buf[18];
-            if (fread(buf, 1, sizeof(buf), fx->file) != sizeof(buf))
+            else
             {
-                printf("Fontx:%s not FONTX format.\n", fx->path);
-                fclose(fx->file);
-                fx->valid = false;
-                fx->file = NULL;
-                return fx->valid;
+                if (FontxDebug)
+                    printf("[openFont]fx->path=[%s]\n", fx->path);
+                f = fopen(fx->path, "r");
+                if (FontxDebug)
+                    printf("[openFont]fopen=%p\n", f);
+                if (f == NULL)
+                {
+                    fx->valid = false;
+                    printf("Fontx:%s not found.\n", fx->path);
+                    return fx->valid;
+                }
+
+                // Read fontx header
+                fx->file = f;
+                if (fread(buf, 1, sizeof(buf), fx->file) != sizeof(buf))
+                {
+                    printf("Fontx:%s not FONTX format.\n", fx->path);
+                    fclose(fx->file);
+                    fx->valid = false;
+                    fx->file = NULL;
+                    return fx->valid;
+                }
             }
 
             if (FontxDebug)
             {
-                for (int i = 0; i < sizeof(buf); i++)
+                for (size_t i = 0; i < sizeof(buf); i++)
                 {
-                    printf("buf[%d]=0x%x\n", i, buf[i]);
+                    printf("buf[%zu]=0x%x\n", i, buf[i]);
                 }
             }
 
@@ -74,6 +114,7 @@ namespace Fontx
             fx->is_ank = (buf[16] == 0);
             fx->bc = buf[17];
             fx->fsz = (fx->w + 7) / 8 * fx->h;
+            fx->metrics = MakeFontxMetrics(fx->w, fx->h);
             if (FontxDebug)
                 printf("[openFont]fx->fsz=%d\n", fx->fsz);
 
@@ -82,7 +123,8 @@ namespace Fontx
             if (fonts == NULL)
             {
                 ESP_LOGE(__FUNCTION__, "Error allocating memory for fonts");
-                fclose(fx->file);
+                if (fx->file != NULL)
+                    fclose(fx->file);
                 fx->valid = false;
                 fx->file = NULL;
                 return fx->valid;
@@ -91,20 +133,159 @@ namespace Fontx
             fx->fonts = fonts;
             fx->opened = true;
             fx->valid = true;
+
+            if (fx->is_ank && !LoadGlyphs(fx))
+            {
+                CloseFontx(fx);
+                return fx->valid;
+            }
         }
         return fx->valid;
     }
 
+    // Load ANK glyphs into RAM
+    // Small fonts are read whole and the file is closed,
+    // larger ones get an LRU cache filled on demand.
+    bool Font::LoadGlyphs(FontxFile *fx)
+    {
+        size_t table_size = (size_t)fx->fsz * FONTX_ANK_GLYPHS;
+
+        if (fx->data != NULL)
+        {
+            if (fx->data_size < 17 + table_size)
+            {
+                printf("Fontx:%s glyph table is truncated.\n", fx->path);
+                return false;
+            }
+            fx->glyphs = fx->data + 17;
+        }
+        else if (table_size <= FONTX_TABLE_MAX)
+        {
+            fx->table = (unsigned char *)malloc(table_size);
+            fx->glyphs = fx->table;
+        }
+
+        if (fx->glyphs != NULL)
+        {
+            if (fx->table != NULL)
+            {
+                if (fseek(fx->file, 17, SEEK_SET) ||
+                    fread(fx->table, 1, table_size, fx->file) != table_size)
+                {
+                    printf("Fontx:%s glyph table read failed.\n", fx->path);
+                    return false;
+                }
+                fx->reads++;
+
+                fclose(fx->file);
+                fx->file = NULL;
+            }
+
+            // Large embedded tables are not worth a rotated copy in RAM
+            if (FONTX_ROTATED && table_size <= FONTX_TABLE_MAX)
+            {
+                fx->rsz = (fx->h + 7) / 8 * fx->w;
+                fx->rotated = (unsigned char *)malloc((size_t)fx->rsz * FONTX_ANK_GLYPHS);
+                if (fx->rotated == NULL)
+                    ESP_LOGW(__FUNCTION__, "No memory for rotated glyphs of %s", fx->path);
+
+                for (int i = 0; fx->rotated != NULL && i < FONTX_ANK_GLYPHS; i++)
+                    RotateGlyph(&fx->glyphs[i * fx->fsz], &fx->rotated[i * fx->rsz], fx->w, fx->h);
+            }
+
+            if (FontxDebug)
+                printf("[LoadGlyphs]%s table=%u bytes\n", fx->path, (unsigned)table_size);
+            return true;
+        }
+
+        fx->cache = (unsigned char *)malloc((size_t)fx->fsz * FONTX_CACHE_SLOTS);
+        if (fx->cache == NULL)
+        {
+            ESP_LOGE(__FUNCTION__, "Error allocating memory for glyph cache");
+            return false;
+        }
+
+        if (FONTX_ROTATED)
+        {
+            fx->rsz = (fx->h + 7) / 8 * fx->w;
+            fx->rotated_cache = (unsigned char *)malloc((size_t)fx->rsz * FONTX_CACHE_SLOTS);
+            if (fx->rotated_cache == NULL)
+                ESP_LOGW(__FUNCTION__, "No memory for rotated glyphs of %s", fx->path);
+        }
+
+        for (int i = 0; i < FONTX_CACHE_SLOTS; i++)
+        {
+            fx->cache_codes[i] = 0xFFFF;
+            fx->cache_used[i] = 0;
+        }
+        fx->cache_tick = 0;
+
+        if (FontxDebug)
+            printf("[LoadGlyphs]%s cache=%d slots\n", fx->path, FONTX_CACHE_SLOTS);
+        return true;
+    }
+
+    // Get glyph from the LRU cache, reading it from file on miss
+    const uint8_t *Font::GetCachedGlyph(FontxFile *fx, uint8_t ascii)
+    {
+        int victim = 0;
+        fx->cache_tick++;
+
+        for (int i = 0; i < FONTX_CACHE_SLOTS; i++)
+        {
+            if (fx->cache_codes[i] == ascii)
+            {
+                fx->cache_used[i] = fx->cache_tick;
+                return &fx->cache[i * fx->fsz];
+            }
+
+            if (fx->cache_used[i] < fx->cache_used[victim])
+                victim = i;
+        }
+
+        uint32_t offset = 17 + ascii * fx->fsz;
+        unsigned char *slot = &fx->cache[victim * fx->fsz];
+        if (fseek(fx->file, offset, SEEK_SET))
+        {
+            printf("Fontx:seek(%" PRIu32 ") failed.\n", offset);
+            return NULL;
+        }
+        if (fread(slot, 1, fx->fsz, fx->file) != fx->fsz)
+        {
+            printf("Fontx:fread failed.\n");
+            fx->cache_codes[victim] = 0xFFFF;
+            return NULL;
+        }
+        fx->reads++;
+
+        if (fx->rotated_cache != NULL)
+            RotateGlyph(slot, &fx->rotated_cache[victim * fx->rsz], fx->w, fx->h);
+
+        fx->cache_codes[victim] = ascii;
+        fx->cache_used[victim] = fx->cache_tick;
+        return slot;
+    }
+
     // Close font file
     // フォントファイルをCLOSE
     void Font::CloseFontx(FontxFile *fx)
     {
         if (fx->opened)
         {
-            fclose(fx->file);
+            if (fx->file != NULL)
+                fclose(fx->file);
             fx->file = NULL;
             free(fx->fonts);
             fx->fonts = NULL;
+            free(fx->table);
+            fx->table = NULL;
+            fx->glyphs = NULL;
+            free(fx->cache);
+            fx->cache = NULL;
+            free(fx->rotated);
+            fx->rotated = NULL;
+            free(fx->rotated_cache);
+            fx->rotated_cache = NULL;
             fx->opened = false;
             fx->valid = false;
         }
@@ -126,6 +307,8 @@ namespace Fontx
             printf("fxs[%d]->fsz=%d\n", i, fxs[i].fsz);
             printf("fxs[%d]->bc=%d\n", i, fxs[i].bc);
             printf("fxs[%d]->valid=%d\n", i, fxs[i].valid);
+            printf("fxs[%d]->glyphs=%s\n", i, fxs[i].glyphs ? "table" : (fxs[i].cache ? "cache" : "none"));
+            printf("fxs[%d]->reads=%" PRIu32 "\n", i, fxs[i].reads);
         }
     }
 
@@ -153,6 +336,25 @@ namespace Fontx
         return (_height);
     }
 
+    // Get font metrics without touching glyph data
+    // Metrics are filled when the font is opened, zero if no font is valid.
+    const FontxMetrics &Font::GetMetrics(FontxFile *fxs)
+    {
+        if (!fxs[0].valid && fxs[1].valid)
+            return fxs[1].metrics;
+        return fxs[0].metrics;
+    }
+
+    // Get font width and height in pixels
+    void Font::GetFontSize(FontxFile *fxs, uint8_t *pw, uint8_t *ph)
+    {
+        const FontxMetrics &metrics = GetMetrics(fxs);
+        if (pw)
+            *pw = metrics.w;
+        if (ph)
+            *ph = metrics.h;
+    }
+
     /*
      Extract font pattern from font file
      フォントファイルからフォントパターンを取り出す
@@ -244,46 +446,102 @@ namespace Fontx
     */
 
     bool Font::GetFontx(FontxFile *fxs, uint8_t ascii, uint8_t *pw, uint8_t *ph)
+    {
+        uint8_t w, h;
+        const uint8_t *glyph = GetGlyph(fxs, ascii, &w, &h);
+        if (glyph == NULL)
+            return false;
+
+        memcpy(fxs->fonts, glyph, (w + 7) / 8 * h);
+        if (pw)
+            *pw = w;
+        if (ph)
+            *ph = h;
+        return true;
+    }
+
+    // Get pointer to glyph pattern, valid until the next lookup in this font
+    const uint8_t *Font::GetGlyph(FontxFile *fxs, uint8_t ascii, uint8_t *pw, uint8_t *ph)
     {
         int i;
-        uint32_t offset;
+        const uint8_t *glyph;
 
         if (FontxDebug)
-            printf("[GetFontx]ascii=0x%x\n", ascii);
+            printf("[GetGlyph]ascii=0x%x\n", ascii);
         for (i = 0; i < 2; i++)
         {
             if (!OpenFontx(&fxs[i]))
                 continue;
             if (FontxDebug)
-                printf("[GetFontx]openFontxFile[%d] ok\n", i);
+                printf("[GetGlyph]openFontxFile[%d] ok\n", i);
 
             // Check ANK font
             if (fxs[i].is_ank)
             {
-                if (FontxDebug)
-                    printf("[GetFontx]fxs.is_ank fxs.fsz=%d\n", fxs[i].fsz);
-                offset = 17 + ascii * fxs[i].fsz;
-                if (FontxDebug)
-                    printf("[GetFontx]offset=%" PRIu32 "\n", offset);
-                if (fseek(fxs[i].file, offset, SEEK_SET))
-                {
-                    printf("Fontx:seek(%" PRIu32 ") failed.\n", offset);
-                    return false;
-                }
-                // if(fread(pGlyph, 1, fxs[i].fsz, fxs[i].file) != fxs[i].fsz) {
-                if (fread(fxs->fonts, 1, fxs[i].fsz, fxs[i].file) != fxs[i].fsz)
-                {
-                    printf("Fontx:fread failed.\n");
-                    return false;
-                }
+                if (fxs[i].glyphs != NULL)
+                    glyph = &fxs[i].glyphs[ascii * fxs[i].fsz];
+                else
+                    glyph = GetCachedGlyph(&fxs[i], ascii);
+
+                if (glyph == NULL)
+                    return NULL;
                 if (pw)
                     *pw = fxs[i].w;
                 if (ph)
                     *ph = fxs[i].h;
-                return true;
+                return glyph;
             }
         }
-        return false;
+        return NULL;
+    }
+
+    // Get glyph rotated for font direction 1, NULL when there is none
+    // Glyph row r is the panel line at y + r, bits go from x + 1 to x + h
+    // (from glyph bottom to top), padded to byte boundary. Valid until the
+    // next lookup in this font.
+    const uint8_t *Font::GetRotatedGlyph(FontxFile *fxs, uint8_t ascii)
+    {
+        for (int i = 0; i < 2; i++)
+        {
+            if (!OpenFontx(&fxs[i]) || !fxs[i].is_ank)
+                continue;
+
+            if (fxs[i].rotated != NULL)
+                return &fxs[i].rotated[ascii * fxs[i].rsz];
+
+            if (fxs[i].rotated_cache == NULL)
+                return NULL;
+
+            const uint8_t *glyph = GetCachedGlyph(&fxs[i], ascii);
+            if (glyph == NULL)
+                return NULL;
+
+            return &fxs[i].rotated_cache[(glyph - fxs[i].cache) / fxs[i].fsz * fxs[i].rsz];
+        }
+        return NULL;
+    }
+
+    // Rotate glyph pattern into panel scan order of font direction 1
+    void Font::RotateGlyph(const uint8_t *glyph, uint8_t *rotated, uint8_t w, uint8_t h)
+    {
+        uint16_t stride = (w + 7) / 8;
+        uint16_t rstride = (h + 7) / 8;
+
+        memset(rotated, 0, rstride * w);
+        for (int r = 0; r < w; r++)
+        {
+            for (int c = 0; c < h; c++)
+            {
+                if (glyph[(h - 1 - c) * stride + r / 8] & (0x80 >> (r % 8)))
+                    rotated[r * rstride + c / 8] |= 0x80 >> (c % 8);
+            }
+        }
+    }
+
+    // Get count of file reads, for profiling glyph access
+    uint32_t Font::GetReadsCount(FontxFile *fxs)
+    {
+        return fxs[0].reads + fxs[1].reads;
     }
 
     /*
@@ -1,8 +1,38 @@
 #ifndef MAIN_FONTX_H_
 #define MAIN_FONTX_H_
 
+#include <stdio.h>
+#include <stdint.h>
+#include "sdkconfig.h"
+
+// ANK tables up to this size are loaded into RAM at once,
+// larger fonts go through the LRU glyph cache.
+#define FONTX_TABLE_MAX CONFIG_FONTX_TABLE_MAX
+#define FONTX_CACHE_SLOTS CONFIG_FONTX_CACHE_SLOTS
+#define FONTX_ANK_GLYPHS 256
+
+// Glyphs are also kept rotated for landscape (font direction 1) text
+#if CONFIG_FONTX_ROTATED
+#define FONTX_ROTATED 1
+#else
+#define FONTX_ROTATED 0
+#endif
+
 namespace Fontx
 {
+    typedef struct
+    {
+        uint8_t w;        // glyph width in pixels
+        uint8_t h;        // glyph height in pixels
+        uint16_t fsz;     // glyph pattern size in bytes
+        uint8_t baseline; // row the underline is drawn on
+    } FontxMetrics;
+
+    constexpr FontxMetrics MakeFontxMetrics(uint8_t w, uint8_t h)
+    {
+        return FontxMetrics{w, h, static_cast<uint16_t>((w + 7) / 8 * h), static_cast<uint8_t>(h - 2)};
+    }
+
     typedef struct
     {
         const char *path;
@@ -14,8 +44,21 @@ namespace Fontx
         uint8_t h;
         uint16_t fsz;
         uint8_t bc;
+        FontxMetrics metrics;
         FILE *file;
         unsigned char *fonts;
+        const uint8_t *data;                      // embedded font file, NULL when read from path
+        size_t data_size;
+        const unsigned char *glyphs;              // whole ANK table, NULL when cached
+        unsigned char *table;                     // ANK table read from file
+        unsigned char *cache;                     // FONTX_CACHE_SLOTS glyphs
+        uint16_t cache_codes[FONTX_CACHE_SLOTS];  // code per slot, 0xFFFF = empty
+        uint32_t cache_used[FONTX_CACHE_SLOTS];   // last use tick per slot
+        uint32_t cache_tick;
+        uint32_t reads;                           // file reads since open
+        uint16_t rsz;                             // rotated glyph size in bytes
+        unsigned char *rotated;                   // rotated ANK table, NULL when cached or disabled
+        unsigned char *rotated_cache;             // rotated glyph per cache slot
     } FontxFile;
 
     class Font
@@ -23,18 +66,30 @@ namespace Fontx
     public:
         static void AddFontx(FontxFile *fx, const char *path);
         static void InitFontx(FontxFile *fxs, const char *f0, const char *f1);
+        static void AddEmbeddedFontx(FontxFile *fx, const char *name, const uint8_t *start, const uint8_t *end);
+        static void InitEmbeddedFontx(FontxFile *fxs, const char *name, const uint8_t *start, const uint8_t *end);
         static bool OpenFontx(FontxFile *fx);
         static void CloseFontx(FontxFile *fx);
         static void DumpFontx(FontxFile *fxs);
         static uint8_t getFontWidth(FontxFile *fx);
         static uint8_t getFontHeight(FontxFile *fx);
+        static const FontxMetrics &GetMetrics(FontxFile *fxs);
+        static void GetFontSize(FontxFile *fxs, uint8_t *pw, uint8_t *ph);
         static bool GetFontx(FontxFile *fxs, uint8_t ascii, uint8_t *pw, uint8_t *ph);
+        static const uint8_t *GetGlyph(FontxFile *fxs, uint8_t ascii, uint8_t *pw, uint8_t *ph);
+        static const uint8_t *GetRotatedGlyph(FontxFile *fxs, uint8_t ascii);
+        static uint32_t GetReadsCount(FontxFile *fxs);
         static void Font2Bitmap(uint8_t *fonts, uint8_t *line, uint8_t w, uint8_t h, uint8_t inverse);
         static void UnderlineBitmap(uint8_t *line, uint8_t w, uint8_t h);
         static void ReversBitmap(uint8_t *line, uint8_t w, uint8_t h);
         static void ShowFont(uint8_t *fonts, uint8_t pw, uint8_t ph);
         static void ShowBitmap(uint8_t *bitmap, uint8_t pw, uint8_t ph);
         static uint8_t RotateByte(uint8_t ch);
+        static void RotateGlyph(const uint8_t *glyph, uint8_t *rotated, uint8_t w, uint8_t h);
+
+    private:
+        static bool LoadGlyphs(FontxFile *fx);
+        static const uint8_t *GetCachedGlyph(FontxFile *fx, uint8_t ascii);
     };
 }
 // UTF8 to SJIS table
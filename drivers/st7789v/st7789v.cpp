@@ -1,6 +1,7 @@
 #include <string.h>
 #include <inttypes.h>
 #include <math.h>
+#include <algorithm>
 
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
@@ -8,9 +9,15 @@
 #include <driver/spi_master.h>
 #include <driver/gpio.h>
 #include "esp_log.h"
+#include "esp_heap_caps.h"
+#include "esp_attr.h"
 
 #include "st7789v.h"
 
+#if CONFIG_IDF_TARGET_LINUX
+#include "st7789v-emulator.h"
+#endif
+
 #define TAG "ST7789"
 #define _DEBUG_ 0
 
@@ -18,11 +25,22 @@
 
 #define SPI_DEFAULT_FREQUENCY SPI_MASTER_FREQ_20M; // 20MHz
 
+#define SPI_MAX_TRANSFER (16 * 1024)  // bus max_transfer_sz, bytes
+#define STRIP_BUFFER_MAX SPI_MAX_TRANSFER // largest string strip, bytes
+
 static const int SPI_Command_Mode = 0;
 static const int SPI_Data_Mode = 1;
 
 int clock_speed_hz = SPI_DEFAULT_FREQUENCY;
 
+static gpio_num_t spi_dc_gpio = GPIO_NUM_NC;
+
+// Set DC line for queued transaction, level is passed in user field
+static void IRAM_ATTR spi_pre_transfer_callback(spi_transaction_t *t)
+{
+    gpio_set_level(spi_dc_gpio, (int)(intptr_t)t->user);
+}
+
 namespace LCD
 {
 
@@ -110,7 +128,7 @@ namespace LCD
             .sclk_io_num = GPIO_SCLK,
             .quadwp_io_num = -1,
             .quadhd_io_num = -1,
-            .max_transfer_sz = 0,
+            .max_transfer_sz = SPI_MAX_TRANSFER,
             .flags = 0};
 
         ret = spi_bus_initialize(HOST_ID, &buscfg, SPI_DMA_CH2);
@@ -121,7 +139,8 @@ namespace LCD
         memset(&devcfg, 0, sizeof(devcfg));
         // devcfg.clock_speed_hz = SPI_Frequency;
         devcfg.clock_speed_hz = clock_speed_hz;
-        devcfg.queue_size = 7;
+        devcfg.queue_size = ST7789V_QUEUE_SIZE;
+        devcfg.pre_cb = spi_pre_transfer_callback;
         // devcfg.mode = 2;
         devcfg.mode = 3;
         devcfg.flags = SPI_DEVICE_NO_DUMMY;
@@ -142,24 +161,84 @@ namespace LCD
         dev._dc = GPIO_DC;
         dev._bl = GPIO_BL;
         dev._SPIHandle = handle;
+        spi_dc_gpio = GPIO_DC;
+
+#if CONFIG_IDF_TARGET_LINUX
+        Emulator::AttachPanel(GPIO_DC);
+#endif
+
+        ESP_ERROR_CHECK(spi_queue_init());
     }
 
-    bool ST7789V::spi_master_write_byte(spi_device_handle_t SPIHandle, const uint8_t *Data, size_t DataLength)
+    // Allocate DMA buffers for queued transfers
+    esp_err_t ST7789V::spi_queue_init()
     {
-        spi_transaction_t SPITransaction;
-        esp_err_t ret;
+        for (int i = 0; i < ST7789V_QUEUE_BUFFERS; i++)
+        {
+            queue.buffers[i] = (uint8_t *)heap_caps_malloc(ST7789V_QUEUE_BUFFER_SIZE, MALLOC_CAP_DMA);
+            if (queue.buffers[i] == NULL)
+            {
+                ESP_LOGE(TAG, "Error allocating DMA buffer for display transfers");
+                return ESP_ERR_NO_MEM;
+            }
+        }
+
+        fill.pattern = (uint8_t *)heap_caps_malloc(ST7789V_FILL_PATTERN_SIZE, MALLOC_CAP_DMA);
+        if (fill.pattern == NULL)
+        {
+            ESP_LOGE(TAG, "Error allocating DMA buffer for fill pattern");
+            return ESP_ERR_NO_MEM;
+        }
+        return ESP_OK;
+    }
+
+    // Wait for the oldest queued transaction to finish
+    void ST7789V::spi_queue_reclaim()
+    {
+        spi_transaction_t *SPITransaction;
+        ESP_ERROR_CHECK(spi_device_get_trans_result(dev._SPIHandle, &SPITransaction, portMAX_DELAY));
+        queue.done++;
+    }
+
+    // Get next DMA buffer, waits until its previous transfer is done
+    // Buffer is valid to fill until the next spi_queue_buffer call.
+    uint8_t *ST7789V::spi_queue_buffer()
+    {
+        queue.buffer = (queue.buffer + 1) % ST7789V_QUEUE_BUFFERS;
+        WaitFence(queue.buffer_fences[queue.buffer]);
+        return queue.buffers[queue.buffer];
+    }
 
+    // Queue data for transfer, Data must stay unchanged until its fence is passed
+    // Up to 4 bytes are copied into the transaction itself.
+    bool ST7789V::spi_master_write_byte(const uint8_t *Data, size_t DataLength, int dc)
+    {
         if (DataLength > 0)
         {
-            memset(&SPITransaction, 0, sizeof(spi_transaction_t));
-            SPITransaction.length = DataLength * 8;
-            SPITransaction.tx_buffer = Data;
-#if 1
-            ret = spi_device_transmit(SPIHandle, &SPITransaction);
-#else
-            ret = spi_device_polling_transmit(SPIHandle, &SPITransaction);
-#endif
-            assert(ret == ESP_OK);
+            if (queue.queued - queue.done == ST7789V_QUEUE_SIZE)
+                spi_queue_reclaim();
+
+            spi_transaction_t *SPITransaction = &queue.trans[queue.queued % ST7789V_QUEUE_SIZE];
+            memset(SPITransaction, 0, sizeof(spi_transaction_t));
+            SPITransaction->length = DataLength * 8;
+            SPITransaction->user = (void *)(intptr_t)dc;
+            if (DataLength <= sizeof(SPITransaction->tx_data))
+            {
+                SPITransaction->flags = SPI_TRANS_USE_TXDATA;
+                memcpy(SPITransaction->tx_data, Data, DataLength);
+            }
+            else
+            {
+                SPITransaction->tx_buffer = Data;
+            }
+
+            ESP_ERROR_CHECK(spi_device_queue_trans(dev._SPIHandle, SPITransaction, portMAX_DELAY));
+            queue.queued++;
+            if (Data == queue.buffers[queue.buffer])
+                queue.buffer_fences[queue.buffer] = queue.queued;
+
+            stats.transactions++;
+            stats.bytes += DataLength;
         }
 
         return true;
@@ -167,69 +246,176 @@ namespace LCD
 
     bool ST7789V::spi_master_write_command(uint8_t cmd)
     {
-        static uint8_t Byte = 0;
-        Byte = cmd;
-        gpio_set_level(dev._dc, SPI_Command_Mode);
-        return spi_master_write_byte(dev._SPIHandle, &Byte, 1);
+        return spi_master_write_byte(&cmd, 1, SPI_Command_Mode);
     }
 
     bool ST7789V::spi_master_write_data_byte(uint8_t data)
     {
-        static uint8_t Byte = 0;
-        Byte = data;
-        gpio_set_level(dev._dc, SPI_Data_Mode);
-        return spi_master_write_byte(dev._SPIHandle, &Byte, 1);
+        return spi_master_write_byte(&data, 1, SPI_Data_Mode);
     }
 
     bool ST7789V::spi_master_write_data_word(uint16_t data)
     {
-        static uint8_t Byte[2];
+        uint8_t Byte[2];
         Byte[0] = (data >> 8) & 0xFF;
         Byte[1] = data & 0xFF;
-        gpio_set_level(dev._dc, SPI_Data_Mode);
-        return spi_master_write_byte(dev._SPIHandle, Byte, 2);
+        return spi_master_write_byte(Byte, 2, SPI_Data_Mode);
     }
 
     bool ST7789V::spi_master_write_addr(uint16_t addr1, uint16_t addr2)
     {
-        static uint8_t Byte[4];
+        uint8_t Byte[4];
         Byte[0] = (addr1 >> 8) & 0xFF;
         Byte[1] = addr1 & 0xFF;
         Byte[2] = (addr2 >> 8) & 0xFF;
         Byte[3] = addr2 & 0xFF;
-        gpio_set_level(dev._dc, SPI_Data_Mode);
-        return spi_master_write_byte(dev._SPIHandle, Byte, 4);
+        return spi_master_write_byte(Byte, 4, SPI_Data_Mode);
     }
 
     bool ST7789V::spi_master_write_color(Color color, uint16_t size)
     {
-        static uint8_t Byte[1024];
-        int index = 0;
-        for (int i = 0; i < size; i++)
+        while (size > 0)
         {
-            Byte[index++] = ((uint16_t)color >> 8) & 0xFF;
-            Byte[index++] = (uint16_t)color & 0xFF;
+            uint16_t count = size > ST7789V_QUEUE_BUFFER_SIZE / 2 ? ST7789V_QUEUE_BUFFER_SIZE / 2 : size;
+            uint8_t *Byte = spi_queue_buffer();
+            FillPixels(Byte, count, (uint16_t)color);
+            spi_master_write_byte(Byte, PackPixels(Byte, count), SPI_Data_Mode);
+            size -= count;
         }
-        gpio_set_level(dev._dc, SPI_Data_Mode);
-        return spi_master_write_byte(dev._SPIHandle, Byte, size * 2);
+        return true;
+    }
+
+    // Write count pixels of one color
+    // The pattern buffer is prepared once per color and sent repeatedly.
+    bool ST7789V::spi_master_write_fill(Color color, uint32_t count)
+    {
+        if (!fill.valid || fill.color != (uint16_t)color)
+        {
+            WaitFence(fill.fence);
+            FillPixels(fill.pattern, ST7789V_FILL_PATTERN_SIZE / 2, (uint16_t)color);
+            // Whole pixel pairs, so RGB444 chunks stay aligned
+            fill.length = PackPixels(fill.pattern, ST7789V_FILL_PATTERN_SIZE / 4 * 2);
+            fill.color = (uint16_t)color;
+            fill.valid = true;
+        }
+
+        size_t length = PixelBytes(count);
+        while (length > 0)
+        {
+            size_t chunk = length > fill.length ? fill.length : length;
+            spi_master_write_byte(fill.pattern, chunk, SPI_Data_Mode);
+            length -= chunk;
+        }
+        fill.fence = GetFence();
+        return true;
     }
 
     // Add 202001
     bool ST7789V::spi_master_write_colors(Color *colors, uint16_t size)
     {
-        static uint8_t Byte[1024];
-        int index = 0;
-        for (int i = 0; i < size; i++)
+        while (size > 0)
         {
-            Byte[index++] = ((uint16_t)colors[i] >> 8) & 0xFF;
-            Byte[index++] = (uint16_t)colors[i] & 0xFF;
+            uint16_t count = size > ST7789V_QUEUE_BUFFER_SIZE / 2 ? ST7789V_QUEUE_BUFFER_SIZE / 2 : size;
+            uint8_t *Byte = spi_queue_buffer();
+            int index = 0;
+            for (int i = 0; i < count; i++)
+            {
+                Byte[index++] = ((uint16_t)colors[i] >> 8) & 0xFF;
+                Byte[index++] = (uint16_t)colors[i] & 0xFF;
+            }
+            spi_master_write_byte(Byte, PackPixels(Byte, count), SPI_Data_Mode);
+            colors += count;
+            size -= count;
         }
-        gpio_set_level(dev._dc, SPI_Data_Mode);
-        return spi_master_write_byte(dev._SPIHandle, Byte, size * 2);
+        return true;
+    }
+
+    // Write pixels saved as 16 bit values, Color is wider so they can't be cast to it
+    bool ST7789V::spi_master_write_colors(const uint16_t *colors, size_t size)
+    {
+        while (size > 0)
+        {
+            size_t count = size > ST7789V_QUEUE_BUFFER_SIZE / 2 ? ST7789V_QUEUE_BUFFER_SIZE / 2 : size;
+            uint8_t *Byte = spi_queue_buffer();
+            for (size_t i = 0; i < count; i++)
+            {
+                Byte[i * 2] = (colors[i] >> 8) & 0xFF;
+                Byte[i * 2 + 1] = colors[i] & 0xFF;
+            }
+            spi_master_write_byte(Byte, PackPixels(Byte, count), SPI_Data_Mode);
+            colors += count;
+            size -= count;
+        }
+        return true;
+    }
+
+    // Write RGB565 pixels, already in panel byte order
+    // Pixels are packed in place for current pixel format, they must stay
+    // unchanged until the transfer fence is passed.
+    bool ST7789V::spi_master_write_pixels(uint8_t *pixels, size_t length)
+    {
+        // Transfers end on whole pixels in both formats
+        const size_t max_chunk = SPI_MAX_TRANSFER - SPI_MAX_TRANSFER % 6;
+
+        length = PackPixels(pixels, length / 2);
+        while (length > 0)
+        {
+            size_t chunk = length > max_chunk ? max_chunk : length;
+            spi_master_write_byte(pixels, chunk, SPI_Data_Mode);
+            pixels += chunk;
+            length -= chunk;
+        }
+        return true;
+    }
+
+    // Convert RGB565 pixels in panel byte order to current pixel format in place
+    // Returns bytes to send. RGB444 packs two pixels into three bytes.
+    size_t ST7789V::PackPixels(uint8_t *pixels, size_t count)
+    {
+        if (pixel_format != PIXEL_FORMAT_RGB444)
+            return count * 2;
+
+        auto rgb444 = [](const uint8_t *pixel)
+        {
+            uint16_t c = (pixel[0] << 8) | pixel[1];
+            return (uint16_t)((((c >> 12) & 0x0F) << 8) | (((c >> 7) & 0x0F) << 4) | ((c >> 1) & 0x0F));
+        };
+
+        // Three bytes out for every four read, so packing in place is safe
+        size_t length = 0;
+        for (size_t i = 0; i < count; i += 2)
+        {
+            uint16_t first = rgb444(&pixels[i * 2]);
+            uint16_t second = i + 1 < count ? rgb444(&pixels[i * 2 + 2]) : 0;
+
+            pixels[length++] = first >> 4;
+            pixels[length++] = ((first & 0x0F) << 4) | (second >> 8);
+            if (i + 1 < count)
+                pixels[length++] = second & 0xFF;
+        }
+        return length;
+    }
+
+    // Bytes count pixels take in current pixel format
+    size_t ST7789V::PixelBytes(size_t count)
+    {
+        return pixel_format == PIXEL_FORMAT_RGB444 ? (count * 3 + 1) / 2 : count * 2;
+    }
+
+    // Set address window and start memory write
+    bool ST7789V::spi_master_write_window(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2)
+    {
+        spi_master_write_command(0x2A); // set column(x) address
+        spi_master_write_addr(x1 + dev._offsetx, x2 + dev._offsetx);
+        spi_master_write_command(0x2B); // set Page(y) address
+        spi_master_write_addr(y1 + dev._offsety, y2 + dev._offsety);
+        return spi_master_write_command(0x2C); // Memory Write
     }
 
     void ST7789V::delayMS(int ms)
     {
+        Flush();
+
         int _ms = ms + (portTICK_PERIOD_MS - 1);
         TickType_t xTicksToDelay = _ms / portTICK_PERIOD_MS;
         ESP_LOGD(TAG, "ms=%d _ms=%d portTICK_PERIOD_MS=%" PRIu32 " xTicksToDelay=%" PRIu32, ms, _ms, portTICK_PERIOD_MS, xTicksToDelay);
@@ -291,23 +477,156 @@ namespace LCD
 
         dev._use_frame_buffer = false;
 #if CONFIG_FRAME_BUFFER
+        EnableFrameBuffer();
+#endif
+    }
+
+    // Draw to RAM frame buffer from now on, changed areas go out on DrawFinish
+    // Returns false when the buffer can't be allocated, drawing stays direct.
+    // Buffer starts black and is pushed whole on the next DrawFinish.
+    bool ST7789V::EnableFrameBuffer()
+    {
+        if (dev._use_frame_buffer)
+            return true;
+
         ESP_LOGI(TAG, "MALLOC_CAP_DEFAULT: %d bytes", heap_caps_get_free_size(MALLOC_CAP_DEFAULT));
         ESP_LOGI(TAG, "MALLOC_CAP_INTERNAL: %d bytes", heap_caps_get_free_size(MALLOC_CAP_INTERNAL));
         ESP_LOGI(TAG, "MALLOC_CAP_SPIRAM: %d bytes", heap_caps_get_free_size(MALLOC_CAP_SPIRAM));
         ESP_LOGI(TAG, "Free heap size: %" PRIu32, esp_get_free_heap_size());
-        dev._frame_buffer = heap_caps_malloc(sizeof(uint16_t) * width * height, MALLOC_CAP_DEFAULT);
+        size_t line_size = sizeof(uint16_t) * dev._width;
+        dev._frame_strip_height = dev._height;
+        dev._frame_buffer = (uint16_t *)heap_caps_calloc(dev._height, line_size, MALLOC_CAP_DEFAULT);
         if (dev._frame_buffer == NULL)
         {
-            ESP_LOGE(TAG, "heap_caps_malloc fail. Frame buffer is not available.");
+            // Whole buffer doesn't fit in one block, try two half-height strips
+            dev._frame_strip_height = (dev._height + 1) / 2;
+            dev._frame_buffer = (uint16_t *)heap_caps_calloc(dev._frame_strip_height, line_size, MALLOC_CAP_DEFAULT);
+            dev._frame_buffer2 = (uint16_t *)heap_caps_calloc(dev._height - dev._frame_strip_height, line_size, MALLOC_CAP_DEFAULT);
+            if (dev._frame_buffer2 == NULL)
+            {
+                free(dev._frame_buffer);
+                dev._frame_buffer = NULL;
+            }
         }
-        else
+
+        if (dev._frame_buffer == NULL)
         {
-            ESP_LOGI(TAG, "heap_caps_malloc success. Frame buffer is available.");
-            dev._use_frame_buffer = true;
+            ESP_LOGE(TAG, "heap_caps_malloc fail. Frame buffer is not available.");
+            return false;
         }
+
+        ESP_LOGI(TAG, "heap_caps_malloc success. Frame buffer is available in %d strip(s).",
+                 dev._frame_buffer2 == NULL ? 1 : 2);
+        dev._use_frame_buffer = true;
+        MarkDirty(0, 0, dev._width - 1, dev._height - 1);
+        return true;
+    }
+
+    // Push pending frame buffer changes, free the buffer and draw straight
+    // to the panel again. Buffer kept for CONFIG_FRAME_BUFFER stays on.
+    void ST7789V::DisableFrameBuffer()
+    {
+#if !CONFIG_FRAME_BUFFER
+        if (dev._use_frame_buffer == false)
+            return;
+
+        DrawFinish();
+        free(dev._frame_buffer);
+        free(dev._frame_buffer2);
+        dev._frame_buffer = NULL;
+        dev._frame_buffer2 = NULL;
+        dev._use_frame_buffer = false;
 #endif
     }
 
+    // Get frame buffer line, the buffer may be split in two strips
+    uint16_t *ST7789V::FrameLine(uint16_t y)
+    {
+        if (y < dev._frame_strip_height)
+            return &dev._frame_buffer[y * dev._width];
+        return &dev._frame_buffer2[(y - dev._frame_strip_height) * dev._width];
+    }
+
+    // Record damaged frame buffer area, pushed to panel by DrawFinish
+    // Touching areas are merged, when the list is full the new area joins
+    // the one that grows least.
+    void ST7789V::MarkDirty(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2)
+    {
+        RECT_t rect{x1, y1, x2, y2};
+
+        int i = 0;
+        while (i < dirty_count)
+        {
+            RECT_t &other = dirty[i];
+            if (other.x1 <= rect.x2 + 1 && rect.x1 <= other.x2 + 1 &&
+                other.y1 <= rect.y2 + 1 && rect.y1 <= other.y2 + 1)
+            {
+                rect = RECT_t{std::min(rect.x1, other.x1), std::min(rect.y1, other.y1),
+                              std::max(rect.x2, other.x2), std::max(rect.y2, other.y2)};
+                dirty[i] = dirty[--dirty_count];
+                i = 0; // merged area may touch ones already checked
+                continue;
+            }
+            i++;
+        }
+
+        if (dirty_count < DIRTY_RECTS_MAX)
+        {
+            dirty[dirty_count++] = rect;
+            return;
+        }
+
+        int best = 0;
+        uint32_t best_growth = UINT32_MAX;
+        for (i = 0; i < dirty_count; i++)
+        {
+            RECT_t &other = dirty[i];
+            uint32_t area = (other.x2 - other.x1 + 1) * (other.y2 - other.y1 + 1);
+            uint32_t merged = (std::max(rect.x2, other.x2) - std::min(rect.x1, other.x1) + 1) *
+                              (std::max(rect.y2, other.y2) - std::min(rect.y1, other.y1) + 1);
+            if (merged - area < best_growth)
+            {
+                best_growth = merged - area;
+                best = i;
+            }
+        }
+
+        RECT_t &other = dirty[best];
+        rect = RECT_t{std::min(rect.x1, other.x1), std::min(rect.y1, other.y1),
+                      std::max(rect.x2, other.x2), std::max(rect.y2, other.y2)};
+        dirty[best] = dirty[--dirty_count];
+        MarkDirty(rect.x1, rect.y1, rect.x2, rect.y2);
+    }
+
+    // Push frame buffer area to panel
+    void ST7789V::FlushRect(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2)
+    {
+        uint16_t width = x2 - x1 + 1;
+        size_t capacity = ST7789V_QUEUE_BUFFER_SIZE / 2;
+        uint8_t *Byte = spi_queue_buffer();
+        size_t count = 0;
+
+        spi_master_write_window(x1, y1, x2, y2);
+        for (uint16_t j = y1; j <= y2; j++)
+        {
+            uint16_t *line = FrameLine(j) + x1;
+            for (uint16_t i = 0; i < width; i++)
+            {
+                Byte[count * 2] = (line[i] >> 8) & 0xFF;
+                Byte[count * 2 + 1] = line[i] & 0xFF;
+                if (++count == capacity)
+                {
+                    spi_master_write_byte(Byte, PackPixels(Byte, count), SPI_Data_Mode);
+                    Byte = spi_queue_buffer();
+                    count = 0;
+                }
+            }
+        }
+
+        if (count > 0)
+            spi_master_write_byte(Byte, PackPixels(Byte, count), SPI_Data_Mode);
+    }
+
     // Draw pixel
     // x:X coordinate
     // y:Y coordinate
@@ -321,7 +640,8 @@ namespace LCD
 
         if (dev._use_frame_buffer)
         {
-            dev._frame_buffer[y * dev._width + x] = (uint16_t)color;
+            FrameLine(y)[x] = (uint16_t)color;
+            MarkDirty(x, y, x, y);
         }
         else
         {
@@ -361,9 +681,10 @@ namespace LCD
             {
                 for (int16_t i = _x1; i <= _x2; i++)
                 {
-                    dev._frame_buffer[j * dev._width + i] = (uint16_t)colors[index++];
+                    FrameLine(j)[i] = (uint16_t)colors[index++];
                 }
             }
+            MarkDirty(_x1, _y1, _x2, _y2);
         }
         else
         {
@@ -404,11 +725,13 @@ namespace LCD
         {
             for (int16_t j = y1; j <= y2; j++)
             {
+                uint16_t *line = FrameLine(j);
                 for (int16_t i = x1; i <= x2; i++)
                 {
-                    dev._frame_buffer[j * dev._width + i] = (uint16_t)color;
+                    line[i] = (uint16_t)color;
                 }
             }
+            MarkDirty(x1, y1, x2, y2);
         }
         else
         {
@@ -422,11 +745,7 @@ namespace LCD
             spi_master_write_command(0x2B); // set Page(y) address
             spi_master_write_addr(_y1, _y2);
             spi_master_write_command(0x2C); // Memory Write
-            for (int i = _x1; i <= _x2; i++)
-            {
-                uint16_t size = _y2 - _y1 + 1;
-                spi_master_write_color(color, size);
-            }
+            spi_master_write_fill(color, (uint32_t)(_x2 - _x1 + 1) * (_y2 - _y1 + 1));
         }
     }
 
@@ -838,6 +1157,66 @@ namespace LCD
         }
     }
 
+    // Get where glyph pixels land for the current font direction
+    // Glyph pixel (h, w) lands on (xss + w * wdx + h * hdx, yss + w * wdy + h * hdy),
+    // always inside the cell (x0, y0)-(x1, y1)
+    void ST7789V::PlaceGlyph(int16_t x, int16_t y, uint8_t pw, uint8_t ph, GLYPH_PLACE_t *place)
+    {
+        *place = GLYPH_PLACE_t{};
+        if (dev._font_direction == 0)
+        {
+            place->wdx = +1;
+            place->hdy = +1; //-1;
+            place->xss = x;
+            place->yss = y - (ph - 1);
+            place->next = x + pw;
+
+            place->x0 = x;
+            place->y0 = y - (ph - 1);
+            place->x1 = x + (pw - 1);
+            place->y1 = y;
+        }
+        else if (dev._font_direction == 2)
+        {
+            place->wdx = -1;
+            place->hdy = -1; //+1;
+            place->xss = x;
+            place->yss = y + (ph - 1);
+            place->next = x - pw;
+
+            place->x0 = x - (pw - 1);
+            place->y0 = y;
+            place->x1 = x;
+            place->y1 = y + (ph - 1);
+        }
+        else if (dev._font_direction == 1)
+        {
+            place->hdx = -1;
+            place->wdy = +1; //-1;
+            place->xss = x + (ph - 1);
+            place->yss = y;
+            place->next = y + pw; // y - pw;
+
+            place->x0 = x;
+            place->y0 = y;
+            place->x1 = x + (ph - 1);
+            place->y1 = y + (pw - 1);
+        }
+        else if (dev._font_direction == 3)
+        {
+            place->hdx = +1;
+            place->wdy = -1; //+1;
+            place->xss = x - (ph - 1);
+            place->yss = y;
+            place->next = y - pw; // y + pw;
+
+            place->x0 = x - (ph - 1);
+            place->y0 = y - (pw - 1);
+            place->x1 = x;
+            place->y1 = y;
+        }
+    }
+
     // Draw ASCII character
     // x:X coordinate
     // y:Y coordinate
@@ -845,153 +1224,308 @@ namespace LCD
     // color:color
     int ST7789V::DrawChar(FontxFile *fxs, uint16_t x, uint16_t y, uint8_t ascii, Color color)
     {
-        uint16_t xx, yy, bit, ofs;
         unsigned char pw, ph;
-        int h, w;
-        uint16_t mask;
-        bool rc;
+        const uint8_t *glyph;
+        GLYPH_PLACE_t place;
 
         if (_DEBUG_)
             printf("_font_direction=%d\n", dev._font_direction);
-        rc = Font::GetFontx(fxs, ascii, &pw, &ph);
+        glyph = Font::GetGlyph(fxs, ascii, &pw, &ph);
         if (_DEBUG_)
-            printf("GetFontx rc=%d pw=%d ph=%d\n", rc, pw, ph);
-        if (!rc)
+            printf("GetGlyph rc=%d pw=%d ph=%d\n", glyph != NULL, pw, ph);
+        if (glyph == NULL)
             return 0;
 
-        int16_t xd1 = 0;
-        int16_t yd1 = 0;
-        int16_t xd2 = 0;
-        int16_t yd2 = 0;
-        uint16_t xss = 0;
-        uint16_t yss = 0;
-        int16_t xsd = 0;
-        int16_t ysd = 0;
-        int16_t next = 0;
-        uint16_t x0 = 0;
-        uint16_t x1 = 0;
-        uint16_t y0 = 0;
-        uint16_t y1 = 0;
-        if (dev._font_direction == 0)
+        PlaceGlyph(x, y, pw, ph, &place);
+        int16_t next = place.next < 0 ? 0 : place.next;
+        if (dev._font_direction == 1)
+            place.rotated = Font::GetRotatedGlyph(fxs, ascii);
+
+        bool on_screen = place.x0 >= 0 && place.y0 >= 0 && place.x1 < dev._width && place.y1 < dev._height;
+
+        if (dev._use_frame_buffer && on_screen)
         {
-            xd1 = +1;
-            yd1 = +1; //-1;
-            xd2 = 0;
-            yd2 = 0;
-            xss = x;
-            yss = y - (ph - 1);
-            xsd = 1;
-            ysd = 0;
-            next = x + pw;
-
-            x0 = x;
-            y0 = y - (ph - 1);
-            x1 = x + (pw - 1);
-            y1 = y;
+            FrameGlyph(glyph, pw, ph, &place, color);
+            return next;
         }
-        else if (dev._font_direction == 2)
+
+        if (!dev._use_frame_buffer && on_screen)
         {
-            xd1 = -1;
-            yd1 = -1; //+1;
-            xd2 = 0;
-            yd2 = 0;
-            xss = x;
-            yss = y + ph + 1;
-            xsd = 1;
-            ysd = 0;
-            next = x - pw;
-
-            x0 = x - (pw - 1);
-            y0 = y;
-            x1 = x;
-            y1 = y + (ph - 1);
+            if (dev._font_fill)
+                BlitGlyph(glyph, pw, ph, &place, place.x0, place.y0, place.x1, place.y1, color);
+            else
+                DrawGlyphRuns(glyph, pw, ph, &place, color);
+            return next;
         }
-        else if (dev._font_direction == 1)
+
+        if (dev._font_fill && place.x0 >= 0 && place.y0 >= 0)
+            DrawFillRect(place.x0, place.y0, place.x1, place.y1, (Color)dev._font_fill_color);
+
+        uint16_t stride = (pw + 7) / 8;
+        for (int h = 0; h < ph; h++)
         {
-            xd1 = 0;
-            yd1 = 0;
-            xd2 = -1;
-            yd2 = +1; //-1;
-            xss = x + ph;
-            yss = y;
-            xsd = 0;
-            ysd = 1;
-            next = y + pw; // y - pw;
-
-            x0 = x;
-            y0 = y;
-            x1 = x + (ph - 1);
-            y1 = y + (pw - 1);
+            bool underline = dev._font_underline && h >= ph - 2;
+            for (int w = 0; w < pw; w++)
+            {
+                uint16_t xx = place.xss + w * place.wdx + h * place.hdx;
+                uint16_t yy = place.yss + w * place.wdy + h * place.hdy;
+                if (underline)
+                    DrawPixel(xx, yy, (Color)dev._font_underline_color);
+                else if (glyph[h * stride + w / 8] & (0x80 >> (w % 8)))
+                    DrawPixel(xx, yy, color);
+            }
         }
-        else if (dev._font_direction == 3)
-        {
-            xd1 = 0;
-            yd1 = 0;
-            xd2 = +1;
-            yd2 = -1; //+1;
-            xss = x - (ph - 1);
-            yss = y;
-            xsd = 0;
-            ysd = 1;
-            next = y - pw; // y + pw;
 
-            x0 = x - (ph - 1);
-            y0 = y - (pw - 1);
-            x1 = x;
-            y1 = y;
+        return next;
+    }
+
+    // Fill pixel buffer with one color
+    void ST7789V::FillPixels(uint8_t *pixels, size_t count, uint16_t color)
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            pixels[i * 2] = (color >> 8) & 0xFF;
+            pixels[i * 2 + 1] = color & 0xFF;
         }
+    }
 
-        if (dev._font_fill)
-            DrawFillRect(x0, y0, x1, y1, (Color)dev._font_fill_color);
+    // Expand glyph into pixel buffer of window (wx1, wy1) with ww pixels per line
+    void ST7789V::RasterizeGlyph(uint8_t *pixels, uint16_t ww, int16_t wx1, int16_t wy1,
+                                 const uint8_t *glyph, uint8_t pw, uint8_t ph, const GLYPH_PLACE_t *place, Color color)
+    {
+        uint16_t stride = (pw + 7) / 8;
 
-        int bits;
-        if (_DEBUG_)
-            printf("xss=%d yss=%d\n", xss, yss);
-        ofs = 0;
-        yy = yss;
-        xx = xss;
-        for (h = 0; h < ph; h++)
-        {
-            if (xsd)
-                xx = xss;
-            if (ysd)
-                yy = yss;
-            // for(w=0;w<(pw/8);w++) {
-            bits = pw;
-            for (w = 0; w < ((pw + 4) / 8); w++)
+        // Rotated glyph row is one pixel line going right from (xss - (ph - 1), yss + row)
+        if (place->rotated != NULL)
+        {
+            uint16_t rstride = (ph + 7) / 8;
+            uint8_t hi = ((uint16_t)color >> 8) & 0xFF, lo = (uint16_t)color & 0xFF;
+
+            for (int r = 0; r < pw; r++)
             {
-                mask = 0x80;
-                for (bit = 0; bit < 8; bit++)
+                const uint8_t *bits = &place->rotated[r * rstride];
+                uint8_t *line = &pixels[((place->yss + r - wy1) * ww + (place->xss - (ph - 1) - wx1)) * 2];
+
+                for (int c = 0; c < ph; c++)
                 {
-                    bits--;
-                    if (bits < 0)
-                        continue;
-                    // if(_DEBUG_)printf("xx=%d yy=%d mask=%02x fonts[%d]=%02x\n",xx,yy,mask,ofs,fxs->fonts[ofs]);
-                    if (fxs->fonts[ofs] & mask)
-                    {
-                        DrawPixel(xx, yy, color);
-                    }
-                    else
+                    if (bits[c / 8] & (0x80 >> (c % 8)))
                     {
-                        // if (dev._font_fill) DrawPixel(xx, yy, dev._font_fill_color);
+                        line[c * 2] = hi;
+                        line[c * 2 + 1] = lo;
                     }
-                    if (h == (ph - 2) && dev._font_underline)
-                        DrawPixel(xx, yy, (Color)dev._font_underline_color);
-                    if (h == (ph - 1) && dev._font_underline)
-                        DrawPixel(xx, yy, (Color)dev._font_underline_color);
-                    xx = xx + xd1;
-                    yy = yy + yd2;
-                    mask = mask >> 1;
                 }
-                ofs++;
+
+                // Underline is on the last two glyph rows, first two pixels here
+                for (int c = 0; dev._font_underline && c < 2; c++)
+                {
+                    line[c * 2] = (dev._font_underline_color >> 8) & 0xFF;
+                    line[c * 2 + 1] = dev._font_underline_color & 0xFF;
+                }
             }
-            yy = yy + yd1;
-            xx = xx + xd2;
+            return;
         }
 
-        if (next < 0)
-            next = 0;
-        return next;
+        for (int h = 0; h < ph; h++)
+        {
+            bool underline = dev._font_underline && h >= ph - 2;
+            for (int w = 0; w < pw; w++)
+            {
+                uint16_t fg;
+                if (underline)
+                    fg = dev._font_underline_color;
+                else if (glyph[h * stride + w / 8] & (0x80 >> (w % 8)))
+                    fg = (uint16_t)color;
+                else
+                    continue;
+
+                int16_t px = place->xss + w * place->wdx + h * place->hdx;
+                int16_t py = place->yss + w * place->wdy + h * place->hdy;
+                int index = ((py - wy1) * ww + (px - wx1)) * 2;
+                pixels[index] = (fg >> 8) & 0xFF;
+                pixels[index + 1] = fg & 0xFF;
+            }
+        }
+    }
+
+    // Draw glyph with background as one address window and one memory write
+    // (wx1, wy1)-(wx2, wy2): window, the character cell
+    void ST7789V::BlitGlyph(const uint8_t *glyph, uint8_t pw, uint8_t ph, const GLYPH_PLACE_t *place,
+                            uint16_t wx1, uint16_t wy1, uint16_t wx2, uint16_t wy2, Color color)
+    {
+        uint16_t ww = wx2 - wx1 + 1;
+        uint16_t wh = wy2 - wy1 + 1;
+
+        if (ww * wh * 2 > ST7789V_QUEUE_BUFFER_SIZE)
+        {
+            DrawFillRect(wx1, wy1, wx2, wy2, (Color)dev._font_fill_color);
+            DrawGlyphRuns(glyph, pw, ph, place, color);
+            return;
+        }
+
+        // Window goes out while the glyph is rasterized
+        uint8_t *Byte = spi_queue_buffer();
+        spi_master_write_window(wx1, wy1, wx2, wy2);
+        FillPixels(Byte, ww * wh, dev._font_fill_color);
+        RasterizeGlyph(Byte, ww, wx1, wy1, glyph, pw, ph, place, color);
+        spi_master_write_byte(Byte, PackPixels(Byte, ww * wh), SPI_Data_Mode);
+    }
+
+    // Draw glyph into frame buffer, damaged area is recorded once
+    void ST7789V::FrameGlyph(const uint8_t *glyph, uint8_t pw, uint8_t ph, const GLYPH_PLACE_t *place, Color color)
+    {
+        uint16_t stride = (pw + 7) / 8;
+
+        if (dev._font_fill)
+        {
+            for (int16_t j = place->y0; j <= place->y1; j++)
+            {
+                uint16_t *line = FrameLine(j);
+                for (int16_t i = place->x0; i <= place->x1; i++)
+                    line[i] = dev._font_fill_color;
+            }
+        }
+
+        if (place->rotated != NULL)
+        {
+            uint16_t rstride = (ph + 7) / 8;
+
+            for (int r = 0; r < pw; r++)
+            {
+                const uint8_t *bits = &place->rotated[r * rstride];
+                uint16_t *line = FrameLine(place->yss + r) + place->xss - (ph - 1);
+
+                for (int c = 0; c < ph; c++)
+                {
+                    if (bits[c / 8] & (0x80 >> (c % 8)))
+                        line[c] = (uint16_t)color;
+                }
+
+                for (int c = 0; dev._font_underline && c < 2; c++)
+                    line[c] = dev._font_underline_color;
+            }
+
+            MarkDirty(place->x0, place->y0, place->x1, place->y1);
+            return;
+        }
+
+        for (int h = 0; h < ph; h++)
+        {
+            bool underline = dev._font_underline && h >= ph - 2;
+            for (int w = 0; w < pw; w++)
+            {
+                uint16_t px = place->xss + w * place->wdx + h * place->hdx;
+                uint16_t py = place->yss + w * place->wdy + h * place->hdy;
+                if (underline)
+                    FrameLine(py)[px] = dev._font_underline_color;
+                else if (glyph[h * stride + w / 8] & (0x80 >> (w % 8)))
+                    FrameLine(py)[px] = (uint16_t)color;
+            }
+        }
+
+        MarkDirty(place->x0, place->y0, place->x1, place->y1);
+    }
+
+    // Draw glyph without background, one address window per run of set pixels
+    void ST7789V::DrawGlyphRuns(const uint8_t *glyph, uint8_t pw, uint8_t ph, const GLYPH_PLACE_t *place, Color color)
+    {
+        uint16_t stride = (pw + 7) / 8;
+
+        for (int h = 0; h < ph; h++)
+        {
+            bool underline = dev._font_underline && h >= ph - 2;
+            int w = 0;
+            while (w < pw)
+            {
+                if (!underline && !(glyph[h * stride + w / 8] & (0x80 >> (w % 8))))
+                {
+                    w++;
+                    continue;
+                }
+
+                int run_start = w;
+                while (w < pw && (underline || (glyph[h * stride + w / 8] & (0x80 >> (w % 8)))))
+                    w++;
+
+                int16_t rx1 = place->xss + run_start * place->wdx + h * place->hdx;
+                int16_t ry1 = place->yss + run_start * place->wdy + h * place->hdy;
+                int16_t rx2 = place->xss + (w - 1) * place->wdx + h * place->hdx;
+                int16_t ry2 = place->yss + (w - 1) * place->wdy + h * place->hdy;
+                if (rx2 < rx1)
+                    std::swap(rx1, rx2);
+                if (ry2 < ry1)
+                    std::swap(ry1, ry2);
+
+                spi_master_write_window(rx1, ry1, rx2, ry2);
+                spi_master_write_color(underline ? (Color)dev._font_underline_color : color, w - run_start);
+            }
+        }
+    }
+
+    // Draw whole string with background into one strip buffer and send it at once
+    // Returns false when the string can't go as one strip, nothing is drawn then.
+    bool ST7789V::DrawStringStrip(FontxFile *fx, uint16_t x, uint16_t y, uint8_t *ascii, int length, Color color, int *next)
+    {
+        uint8_t pw, ph;
+        GLYPH_PLACE_t first, last, place;
+
+        Font::GetFontSize(fx, &pw, &ph);
+        if (pw == 0 || ph == 0 || length == 0)
+            return false;
+
+        // Fixed width fonts only, so the strip is spanned by first and last glyphs
+        int16_t adx = dev._font_direction == 0 ? pw : dev._font_direction == 2 ? -pw : 0;
+        int16_t ady = dev._font_direction == 1 ? pw : dev._font_direction == 3 ? -pw : 0;
+        PlaceGlyph(x, y, pw, ph, &first);
+        PlaceGlyph(x + (length - 1) * adx, y + (length - 1) * ady, pw, ph, &last);
+
+        int16_t wx1 = std::min(first.x0, last.x0);
+        int16_t wy1 = std::min(first.y0, last.y0);
+        int16_t wx2 = std::max(first.x1, last.x1);
+        int16_t wy2 = std::max(first.y1, last.y1);
+        if (wx1 < 0 || wy1 < 0 || wx2 >= dev._width || wy2 >= dev._height)
+            return false;
+
+        uint16_t ww = wx2 - wx1 + 1;
+        uint16_t wh = wy2 - wy1 + 1;
+        size_t size = ww * wh * 2;
+        if (size > STRIP_BUFFER_MAX)
+            return false;
+
+        // Strips alternate, so one is rasterized while the other is on the wire
+        strip = (strip + 1) % 2;
+        WaitFence(strip_fences[strip]);
+        if (size > strip_sizes[strip])
+        {
+            free(strip_buffers[strip]);
+            strip_buffers[strip] = (uint8_t *)heap_caps_malloc(size, MALLOC_CAP_DMA);
+            strip_sizes[strip] = strip_buffers[strip] == NULL ? 0 : size;
+            if (strip_buffers[strip] == NULL)
+            {
+                ESP_LOGW(TAG, "Strip buffer of %d bytes is not available", (int)size);
+                return false;
+            }
+        }
+
+        uint8_t *strip_buffer = strip_buffers[strip];
+        FillPixels(strip_buffer, ww * wh, dev._font_fill_color);
+        for (int i = 0; i < length; i++)
+        {
+            const uint8_t *glyph = Font::GetGlyph(fx, ascii[i], NULL, NULL);
+            if (glyph == NULL)
+                return false;
+
+            PlaceGlyph(x + i * adx, y + i * ady, pw, ph, &place);
+            if (dev._font_direction == 1)
+                place.rotated = Font::GetRotatedGlyph(fx, ascii[i]);
+            RasterizeGlyph(strip_buffer, ww, wx1, wy1, glyph, pw, ph, &place, color);
+        }
+
+        spi_master_write_window(wx1, wy1, wx2, wy2);
+        spi_master_write_pixels(strip_buffer, size);
+        strip_fences[strip] = GetFence();
+
+        *next = last.next < 0 ? 0 : last.next;
+        return true;
     }
 
     int ST7789V::DrawString(FontxFile *fx, uint16_t x, uint16_t y, uint8_t *ascii, Color color)
@@ -999,6 +1533,11 @@ namespace LCD
         int length = strlen((char *)ascii);
         if (_DEBUG_)
             printf("lcdDrawString length=%d\n", length);
+
+        int next;
+        if (dev._font_fill && !dev._use_frame_buffer && DrawStringStrip(fx, x, y, ascii, length, color, &next))
+            return next;
+
         for (int i = 0; i < length; i++)
         {
             if (_DEBUG_)
@@ -1161,6 +1700,58 @@ int DrawUTF8String(TFT_t * dev, FontxFile *fx, uint16_t x, uint16_t y, unsigned
         spi_master_write_command(0x21); // Display Inversion On
     }
 
+    // Set interface pixel format, following pixel writes are packed for it
+    // RGB444 takes 25% less bytes, colors lose their lowest bits.
+    void ST7789V::SetPixelFormat(PIXEL_FORMAT_t format)
+    {
+        spi_master_write_command(0x3A); // Interface Pixel Format
+        spi_master_write_data_byte(format == PIXEL_FORMAT_RGB444 ? 0x53 : 0x55);
+        pixel_format = format;
+        fill.valid = false;
+    }
+
+    PIXEL_FORMAT_t ST7789V::GetPixelFormat()
+    {
+        return pixel_format;
+    }
+
+    // Shift rectangular area along X, pixels shifted out are lost
+    // and the exposed band keeps its old content.
+    // Panel memory can't be read back, so this needs the frame buffer.
+    // x1:Start X coordinate
+    // y1:Start Y coordinate
+    // x2:End X coordinate
+    // y2:End Y coordinate
+    // dx:Shift in pixels
+    bool ST7789V::ShiftArea(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2, int16_t dx)
+    {
+        if (dev._use_frame_buffer == false)
+            return false;
+
+        if (x1 >= dev._width || y1 >= dev._height)
+            return false;
+        if (x2 >= dev._width)
+            x2 = dev._width - 1;
+        if (y2 >= dev._height)
+            y2 = dev._height - 1;
+
+        int16_t width = x2 - x1 + 1;
+        if (dx >= width || -dx >= width)
+            return false;
+
+        for (int16_t j = y1; j <= y2; j++)
+        {
+            uint16_t *line = FrameLine(j);
+            if (dx > 0)
+                memmove(&line[x1 + dx], &line[x1], (width - dx) * 2);
+            else if (dx < 0)
+                memmove(&line[x1], &line[x1 - dx], (width + dx) * 2);
+        }
+
+        MarkDirty(x1, y1, x2, y2);
+        return true;
+    }
+
     void ST7789V::WrapArround(SCROLL_TYPE_t scroll, int start, int end)
     {
         if (dev._use_frame_buffer == false)
@@ -1168,64 +1759,59 @@ int DrawUTF8String(TFT_t * dev, FontxFile *fx, uint16_t x, uint16_t y, unsigned
 
         int _width = dev._width;
         int _height = dev._height;
-        int32_t index1;
-        int32_t index2;
+        uint16_t *line;
 
         if (scroll == SCROLL_RIGHT)
         {
             uint16_t wk[_width];
             for (int i = start; i < end; i++)
             {
-                index1 = i * _width;
-                memcpy((char *)wk, (char *)&dev._frame_buffer[index1], _width * 2);
-                index2 = index1 + _width - 1;
-                dev._frame_buffer[index1] = dev._frame_buffer[index2];
-                memcpy((char *)&dev._frame_buffer[index1 + 1], (char *)&wk[0], (_width - 1) * 2);
+                line = FrameLine(i);
+                memcpy((char *)wk, (char *)line, _width * 2);
+                line[0] = wk[_width - 1];
+                memcpy((char *)&line[1], (char *)&wk[0], (_width - 1) * 2);
             }
+            MarkDirty(0, start, _width - 1, end - 1);
         }
         else if (scroll == SCROLL_LEFT)
         {
             uint16_t wk[_width];
             for (int i = start; i < end; i++)
             {
-                index1 = i * _width;
-                memcpy((char *)wk, (char *)&dev._frame_buffer[index1], _width * 2);
-                index2 = index1 + _width - 1;
-                dev._frame_buffer[index2] = dev._frame_buffer[index1];
-                memcpy((char *)&dev._frame_buffer[index1], (char *)&wk[1], (_width - 1) * 2);
+                line = FrameLine(i);
+                memcpy((char *)wk, (char *)line, _width * 2);
+                line[_width - 1] = wk[0];
+                memcpy((char *)line, (char *)&wk[1], (_width - 1) * 2);
             }
+            MarkDirty(0, start, _width - 1, end - 1);
         }
         else if (scroll == SCROLL_UP)
         {
             uint16_t wk;
             for (int i = start; i <= end; i++)
             {
-                wk = dev._frame_buffer[i];
+                wk = FrameLine(0)[i];
                 for (int j = 0; j < _height - 1; j++)
                 {
-                    index1 = j * _width + i;
-                    index2 = (j + 1) * _width + i;
-                    dev._frame_buffer[index1] = dev._frame_buffer[index2];
+                    FrameLine(j)[i] = FrameLine(j + 1)[i];
                 }
-                index2 = (_height - 1) * _width + i;
-                dev._frame_buffer[index2] = wk;
+                FrameLine(_height - 1)[i] = wk;
             }
+            MarkDirty(start, 0, end, _height - 1);
         }
         else if (scroll == SCROLL_DOWN)
         {
             uint16_t wk;
             for (int i = start; i <= end; i++)
             {
-                index2 = (_height - 1) * _width + i;
-                wk = dev._frame_buffer[index2];
+                wk = FrameLine(_height - 1)[i];
                 for (int j = _height - 2; j >= 0; j--)
                 {
-                    index1 = j * _width + i;
-                    index2 = (j + 1) * _width + i;
-                    dev._frame_buffer[index2] = dev._frame_buffer[index1];
+                    FrameLine(j + 1)[i] = FrameLine(j)[i];
                 }
-                dev._frame_buffer[i] = wk;
+                FrameLine(0)[i] = wk;
             }
+            MarkDirty(start, 0, end, _height - 1);
         }
     }
 
@@ -1255,10 +1841,11 @@ int DrawUTF8String(TFT_t * dev, FontxFile *fx, uint16_t x, uint16_t y, unsigned
                 for (int16_t i = x1; i <= x2; i++)
                 {
                     if (save)
-                        save[index++] = dev._frame_buffer[j * dev._width + i];
-                    dev._frame_buffer[j * dev._width + i] = ~dev._frame_buffer[j * dev._width + i];
+                        save[index++] = FrameLine(j)[i];
+                    FrameLine(j)[i] = ~FrameLine(j)[i];
                 }
             }
+            MarkDirty(x1, y1, x2, y2);
         }
         else
         {
@@ -1291,7 +1878,7 @@ int DrawUTF8String(TFT_t * dev, FontxFile *fx, uint16_t x, uint16_t y, unsigned
             {
                 for (int16_t i = x1; i <= x2; i++)
                 {
-                    save[index++] = dev._frame_buffer[j * dev._width + i];
+                    save[index++] = FrameLine(j)[i];
                 }
             }
         }
@@ -1326,13 +1913,67 @@ int DrawUTF8String(TFT_t * dev, FontxFile *fx, uint16_t x, uint16_t y, unsigned
             {
                 for (int16_t i = x1; i <= x2; i++)
                 {
-                    dev._frame_buffer[j * dev._width + i] = save[index++];
+                    FrameLine(j)[i] = save[index++];
                 }
             }
+            MarkDirty(x1, y1, x2, y2);
         }
         else
         {
-            ESP_LOGW(TAG, "Disable frame buffer");
+            spi_master_write_window(x1, y1, x2, y2);
+            spi_master_write_colors(save, (x2 - x1 + 1) * (y2 - y1 + 1));
+        }
+    }
+
+    // Get rectangle area with character drawn in it
+    // With frame buffer the area is read from it. Without it the area is taken
+    // as background with ascii drawn at (x, y), as DrawChar with font fill does.
+    // x1:Start X coordinate
+    // y1:Start Y coordinate
+    // x2:End X coordinate
+    // y2:End Y coordinate
+    // save:Save buffer
+    void ST7789V::GetTextRect(FontxFile *fx, uint16_t x, uint16_t y, uint8_t ascii, Color color, Color background,
+                              uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2, uint16_t *save)
+    {
+        if (dev._use_frame_buffer)
+        {
+            GetRect(x1, y1, x2, y2, save);
+            return;
+        }
+
+        if (x1 >= dev._width || y1 >= dev._height)
+            return;
+        if (x2 >= dev._width)
+            x2 = dev._width - 1;
+        if (y2 >= dev._height)
+            y2 = dev._height - 1;
+
+        uint16_t ww = x2 - x1 + 1;
+        for (int i = 0; i < ww * (y2 - y1 + 1); i++)
+        {
+            save[i] = (uint16_t)background;
+        }
+
+        uint8_t pw, ph;
+        const uint8_t *glyph = Font::GetGlyph(fx, ascii, &pw, &ph);
+        if (glyph == NULL)
+            return;
+
+        GLYPH_PLACE_t place;
+        PlaceGlyph(x, y, pw, ph, &place);
+        uint16_t stride = (pw + 7) / 8;
+        for (int h = 0; h < ph; h++)
+        {
+            for (int w = 0; w < pw; w++)
+            {
+                int16_t xx = place.xss + w * place.wdx + h * place.hdx;
+                int16_t yy = place.yss + w * place.wdy + h * place.hdy;
+                if (xx < x1 || xx > x2 || yy < y1 || yy > y2)
+                    continue;
+                if (glyph[h * stride + w / 8] & (0x80 >> (w % 8)))
+                    save[(yy - y1) * ww + (xx - x1)] = (uint16_t)color;
+            }
         }
     }
 
@@ -1353,29 +1994,47 @@ int DrawUTF8String(TFT_t * dev, FontxFile *fx, uint16_t x, uint16_t y, unsigned
         // DrawCircle(x0, y0, r, color);
     }
 
+    // Get fence of the last queued transfer
+    uint32_t ST7789V::GetFence()
+    {
+        return queue.queued;
+    }
+
+    // Wait until transfers up to fence are done
+    void ST7789V::WaitFence(uint32_t fence)
+    {
+        while ((int32_t)(queue.done - fence) < 0)
+            spi_queue_reclaim();
+    }
+
+    // Wait until all queued transfers are done
+    void ST7789V::Flush()
+    {
+        WaitFence(queue.queued);
+    }
+
+    // Get SPI transfer counters, for profiling drawing paths
+    const SPI_STATS_t &ST7789V::GetStats()
+    {
+        return stats;
+    }
+
+    void ST7789V::ResetStats()
+    {
+        stats = SPI_STATS_t{};
+    }
+
     // Draw Frame Buffer
+    // Only areas changed since the last call are pushed to panel
     void ST7789V::DrawFinish()
     {
         if (dev._use_frame_buffer == false)
             return;
 
-        spi_master_write_command(0x2A); // set column(x) address
-        spi_master_write_addr(dev._offsetx, dev._offsetx + dev._width - 1);
-        spi_master_write_command(0x2B); // set Page(y) address
-        spi_master_write_addr(dev._offsety, dev._offsety + dev._height - 1);
-        spi_master_write_command(0x2C); // Memory Write
-
-        // uint16_t size = dev._width*dev._height;
-        uint32_t size = dev._width * dev._height;
-        uint16_t *image = dev._frame_buffer;
-        while (size > 0)
+        for (int i = 0; i < dirty_count; i++)
         {
-            // 1024 bytes per time.
-            uint16_t bs = (size > 1024) ? 1024 : size;
-            spi_master_write_colors((Color *)image, bs);
-            size -= bs;
-            image += bs;
+            FlushRect(dirty[i].x1, dirty[i].y1, dirty[i].x2, dirty[i].y2);
         }
-        return;
+        dirty_count = 0;
     }
 }
\ No newline at end of file
@@ -3,8 +3,15 @@
 
 #include "driver/spi_master.h"
 #include "driver/gpio.h"
+#include "sdkconfig.h"
 #include "fontx.h"
 
+#define ST7789V_QUEUE_SIZE CONFIG_ST7789V_QUEUE_SIZE
+#define ST7789V_QUEUE_BUFFERS CONFIG_ST7789V_QUEUE_BUFFERS
+#define ST7789V_QUEUE_BUFFER_SIZE CONFIG_ST7789V_QUEUE_BUFFER_SIZE
+#define ST7789V_FILL_PATTERN_SIZE CONFIG_ST7789V_FILL_PATTERN_SIZE
+#define DIRTY_RECTS_MAX 8
+
 using Fontx::Font, Fontx::FontxFile;
 
 #define rgb565(r, g, b) ~(((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3))
@@ -35,6 +42,7 @@ namespace LCD
         Purple = (uint16_t)rgb565(128, 0, 128),  // 0x8010
         DarkGreen = (uint16_t)rgb565(0, 100, 0),
         DarkYellow = (uint16_t)rgb565(213, 182, 10),
+        Orange = (uint16_t)rgb565(255, 165, 0),
         None,
     };
 
@@ -70,21 +78,101 @@ namespace LCD
         spi_device_handle_t _SPIHandle;
         bool _use_frame_buffer;
         uint16_t *_frame_buffer;
+        uint16_t *_frame_buffer2;     // lower strip, NULL when buffer is in one piece
+        uint16_t _frame_strip_height; // lines in _frame_buffer
     } TFT_t;
 
+    typedef struct
+    {
+        uint16_t x1, y1, x2, y2;
+    } RECT_t;
+
+    typedef struct
+    {
+        uint32_t transactions;
+        uint32_t bytes;
+    } SPI_STATS_t;
+
+    typedef struct
+    {
+        int16_t xss, yss;           // position of glyph pixel (0, 0)
+        int16_t wdx, wdy;           // step per glyph column
+        int16_t hdx, hdy;           // step per glyph row
+        int16_t x0, y0, x1, y1;     // cell, font fill area
+        int16_t next;
+        const uint8_t *rotated;     // glyph from rotated atlas, font direction 1 only
+    } GLYPH_PLACE_t;
+
+    typedef struct
+    {
+        spi_transaction_t trans[ST7789V_QUEUE_SIZE];
+        uint8_t *buffers[ST7789V_QUEUE_BUFFERS];
+        uint32_t buffer_fences[ST7789V_QUEUE_BUFFERS]; // fence of last transfer from buffer
+        uint8_t buffer;                                // last handed out buffer
+        uint32_t queued;                               // transactions queued since init
+        uint32_t done;                                 // transactions finished since init
+    } SPI_QUEUE_t;
+
+    typedef enum
+    {
+        PIXEL_FORMAT_RGB565, // COLMOD 0x55, 2 bytes per pixel
+        PIXEL_FORMAT_RGB444, // COLMOD 0x53, 3 bytes per 2 pixels
+    } PIXEL_FORMAT_t;
+
+    typedef struct
+    {
+        uint8_t *pattern; // ST7789V_FILL_PATTERN_SIZE bytes of one color
+        size_t length;    // bytes of pattern in current pixel format
+        uint16_t color;
+        bool valid;
+        uint32_t fence; // fence of last transfer from pattern
+    } FILL_PATTERN_t;
+
     class ST7789V
     {
         void spi_clock_speed(int speed);
         void spi_master_init(gpio_num_t mosi, gpio_num_t clk, gpio_num_t cs, gpio_num_t dc, gpio_num_t rst, gpio_num_t bl);
-        bool spi_master_write_byte(spi_device_handle_t SPIHandle, const uint8_t *Data, size_t DataLength);
+        esp_err_t spi_queue_init();
+        void spi_queue_reclaim();
+        uint8_t *spi_queue_buffer();
+        bool spi_master_write_byte(const uint8_t *Data, size_t DataLength, int dc);
         bool spi_master_write_command(uint8_t cmd);
         bool spi_master_write_data_byte(uint8_t data);
         bool spi_master_write_data_word(uint16_t data);
         bool spi_master_write_addr(uint16_t addr1, uint16_t addr2);
         bool spi_master_write_color(Color color, uint16_t size);
         bool spi_master_write_colors(Color *colors, uint16_t size);
+        bool spi_master_write_colors(const uint16_t *colors, size_t size);
+        bool spi_master_write_fill(Color color, uint32_t count);
+        bool spi_master_write_pixels(uint8_t *pixels, size_t length);
+        size_t PackPixels(uint8_t *pixels, size_t count);
+        size_t PixelBytes(size_t count);
+        bool spi_master_write_window(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2);
+
+        void PlaceGlyph(int16_t x, int16_t y, uint8_t pw, uint8_t ph, GLYPH_PLACE_t *place);
+        void FillPixels(uint8_t *pixels, size_t count, uint16_t color);
+        void RasterizeGlyph(uint8_t *pixels, uint16_t ww, int16_t wx1, int16_t wy1,
+                            const uint8_t *glyph, uint8_t pw, uint8_t ph, const GLYPH_PLACE_t *place, Color color);
+        void BlitGlyph(const uint8_t *glyph, uint8_t pw, uint8_t ph, const GLYPH_PLACE_t *place,
+                       uint16_t wx1, uint16_t wy1, uint16_t wx2, uint16_t wy2, Color color);
+        void FrameGlyph(const uint8_t *glyph, uint8_t pw, uint8_t ph, const GLYPH_PLACE_t *place, Color color);
+        void DrawGlyphRuns(const uint8_t *glyph, uint8_t pw, uint8_t ph, const GLYPH_PLACE_t *place, Color color);
+        uint16_t *FrameLine(uint16_t y);
+        void MarkDirty(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2);
+        void FlushRect(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2);
+        bool DrawStringStrip(FontxFile *fx, uint16_t x, uint16_t y, uint8_t *ascii, int length, Color color, int *next);
 
         TFT_t dev;
+        SPI_QUEUE_t queue{};
+        FILL_PATTERN_t fill{};
+        SPI_STATS_t stats{};
+        uint8_t *strip_buffers[2]{};
+        size_t strip_sizes[2]{};
+        uint32_t strip_fences[2]{};
+        uint8_t strip{};
+        RECT_t dirty[DIRTY_RECTS_MAX]{};
+        uint8_t dirty_count{};
+        PIXEL_FORMAT_t pixel_format{PIXEL_FORMAT_RGB565};
         gpio_num_t _mosi, _clk, _cs, _dc, _rst, _bl;
 
     public:
@@ -127,13 +215,25 @@ namespace LCD
         void BacklightOn();
         void InversionOff();
         void InversionOn();
+        void SetPixelFormat(PIXEL_FORMAT_t format);
+        PIXEL_FORMAT_t GetPixelFormat();
+        bool ShiftArea(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2, int16_t dx);
         void WrapArround(SCROLL_TYPE_t scroll, int start, int end);
         void InversionArea(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2, uint16_t *save);
         void GetRect(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2, uint16_t *save);
         void SetRect(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2, uint16_t *save);
+        void GetTextRect(FontxFile *fx, uint16_t x, uint16_t y, uint8_t ascii, Color color, Color background,
+                         uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2, uint16_t *save);
         void SetCursor(uint16_t x0, uint16_t y0, uint16_t r, Color color, uint16_t *save);
         void ResetCursor(uint16_t x0, uint16_t y0, uint16_t r, Color color, uint16_t *save);
+        bool EnableFrameBuffer();
+        void DisableFrameBuffer();
         void DrawFinish();
+        uint32_t GetFence();
+        void WaitFence(uint32_t fence);
+        void Flush();
+        const SPI_STATS_t &GetStats();
+        void ResetStats();
     };
 }
 
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <memory>
+#include <atomic>
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "esp_task_wdt.h"
@@ -53,12 +54,17 @@ namespace Main
 
         static int64_t last_active_time;
         esp_timer_handle_t deep_sleep_timer;
+        esp_timer_handle_t cursor_blink_timer{};
+        static std::atomic<bool> cursor_blink_pending;
 
         std::unique_ptr<Scene::Scene> scene;
 
         void SwitchScene(Scene::SceneId id);
         esp_err_t InitCodeRunner();
         esp_err_t InitSleepModes();
+        esp_err_t InitCursorBlink();
+        void RestartCursorBlink();
+        static void CursorBlink(void *arg);
 
         void EnterLightSleepMode();
         static void EnterDeepSleepMode(void *arg);
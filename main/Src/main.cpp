@@ -137,6 +137,7 @@ namespace Main
     }
 
     int64_t Main::last_active_time{};
+    std::atomic<bool> Main::cursor_blink_pending{};
 
     Main::Main() : scene{new Scene::StartScene{display}} {}
 
@@ -146,6 +147,7 @@ namespace Main
         ESP_ERROR_CHECK(Settings::Settings::Init());
         ESP_ERROR_CHECK(keyboard.Init());
         ESP_ERROR_CHECK(display.Init());
+        ESP_ERROR_CHECK(InitCursorBlink());
         ESP_ERROR_CHECK(InitCodeRunner());
 
         if (ESP_OK == sdcard.Mount(CONFIG_MOUNT_POINT))
@@ -157,7 +159,9 @@ namespace Main
             ESP_LOGE(TAG, "SD card mount error.");
         }
 
+        display.BeginFrame();
         scene->Init();
+        display.Flush();
     }
 
     void Main::Tick()
@@ -167,6 +171,8 @@ namespace Main
         Scene::SceneId sceneId = Scene::SceneId::CurrentScene;
         bool pressed{};
 
+        display.BeginFrame();
+
         for (auto key : controllers)
         {
             if (KeyboardController::IsKeyPressed(key))
@@ -233,6 +239,17 @@ namespace Main
             }
         }
 
+        if (pressed)
+        {
+            RestartCursorBlink();
+        }
+        else if (cursor_blink_pending.exchange(false))
+        {
+            scene->BlinkCursor();
+        }
+
+        display.Flush();
+
         if (!pressed && !CodeRunController::IsRunning())
         {
             int64_t idle_time{static_cast<int64_t>(esp_timer_get_time() - last_active_time) / 1'000'000LL};
@@ -398,21 +415,25 @@ namespace Main
     void Main::SendCodeOutput(const char *output)
     {
         scene->SendCodeOutput(output);
+        display.Flush();
     }
 
     void Main::SendCodeError(const char *traceback)
     {
         scene->SendCodeError(traceback);
+        display.Flush();
     }
 
     void Main::SendCodeSuccess()
     {
         scene->SendCodeSuccess();
+        display.Flush();
     }
 
     void Main::DisplayCodeLog(bool is_end)
     {
         scene->DisplayCodeLog(is_end);
+        display.Flush();
     }
 
     esp_err_t Main::InitSleepModes()
@@ -451,6 +472,47 @@ namespace Main
         display.BacklightOn();
     }
 
+    // Timer only marks the blink, it is drawn in Tick with the app mutex held
+    esp_err_t Main::InitCursorBlink()
+    {
+        if (CONFIG_CURSOR_BLINK_PERIOD <= 0)
+        {
+            return ESP_OK;
+        }
+
+        const esp_timer_create_args_t tim_args =
+            {
+                .callback = CursorBlink,
+                .name = "cursor_blink_timer",
+            };
+
+        esp_err_t ret = esp_timer_create(&tim_args, &cursor_blink_timer);
+        if (ret != ESP_OK)
+        {
+            return ret;
+        }
+
+        return esp_timer_start_periodic(cursor_blink_timer, CONFIG_CURSOR_BLINK_PERIOD * 1'000LL);
+    }
+
+    // Cursor stays solid while keys are pressed
+    void Main::RestartCursorBlink()
+    {
+        if (cursor_blink_timer == nullptr)
+        {
+            return;
+        }
+
+        esp_timer_stop(cursor_blink_timer);
+        cursor_blink_pending = false;
+        esp_timer_start_periodic(cursor_blink_timer, CONFIG_CURSOR_BLINK_PERIOD * 1'000LL);
+    }
+
+    void Main::CursorBlink(void *arg)
+    {
+        cursor_blink_pending = true;
+    }
+
     void Main::EnterDeepSleepMode(void *arg)
     {
         esp_deep_sleep_start();
@@ -0,0 +1,326 @@
+#include <stdio.h>
+#include <inttypes.h>
+#include <string.h>
+#include <string>
+#include <algorithm>
+
+#include "st7789v.h"
+#include "fontx.h"
+#include "st7789v-emulator.h"
+#include "esp_timer.h"
+
+// Panel driver counts on host: font file reads, SPI transactions and
+// bytes of drawing calls, taken from driver counters and panel emulator
+// while drawing into it. Counts do not depend on host speed, times do.
+
+using LCD::ST7789V, LCD::Color;
+
+// Code text drawn as editor rows of 37 columns
+static const char *code_text{
+    "def area(r):\n    return math.pi * r ** 2 if r > 0 else 0.0\n"
+    "for i in range(3):\n    print(\"r=%d\" % i, area(i))\n"
+    "local t = {n = 0, name = 'lua'}\nfunction t:inc(step) self.n = self.n + 1 end\n"};
+
+static std::string code_chars(size_t chars)
+{
+    std::string text{};
+    while (text.size() < chars)
+    {
+        text += code_text;
+    }
+    text.resize(chars);
+    return text;
+}
+
+static void draw_rows(ST7789V &lcd, FontxFile *fx, size_t chars)
+{
+    std::string text{code_chars(chars)};
+
+    uint8_t fh{Font::getFontHeight(fx)};
+    for (size_t offset{}, row{}; offset < text.size(); offset += 37, row++)
+    {
+        std::string line{text.substr(offset, 37)};
+        lcd.DrawString(fx, 239 - fh - (row * fh) % 200, 10, (uint8_t *)line.c_str(), Color::White);
+    }
+}
+
+// Fonts opened from files, small one is kept whole, large one in glyph cache
+static bool bench_font_reads(ST7789V &lcd)
+{
+    printf("Font file reads, 1000 code chars drawn:\n");
+
+    for (const char *name : {"ILGH16XB", "ILGH32XB"})
+    {
+        std::string path{std::string{FONTS_DIR} + "/" + name + ".FNT"};
+        FontxFile fx[2];
+        Font::InitFontx(fx, path.c_str(), "");
+        if (!fx[0].valid)
+            return false;
+
+        uint32_t opened{Font::GetReadsCount(fx)};
+        lcd.SetFontFill(Color::Black);
+        draw_rows(lcd, fx, 1000);
+        lcd.UnsetFontFill();
+        uint32_t drawn{Font::GetReadsCount(fx) - opened};
+
+        printf("  %s: %s, %" PRIu32 " reads at open, %" PRIu32 " while drawing\n", name,
+               fx[0].glyphs ? "whole table" : "glyph cache", opened, drawn);
+        Font::CloseFontx(&fx[0]);
+    }
+
+    return true;
+}
+
+// Transactions and bytes per DrawChar of code text with and without font
+// fill. Per pixel loop sent one DrawPixel per set glyph bit, its cost is
+// counted here from one DrawPixel.
+static void bench_glyph_stats(ST7789V &lcd, FontxFile *fx)
+{
+    std::string text{code_chars(1000)};
+    std::replace(text.begin(), text.end(), '\n', ' ');
+
+    uint8_t fw, fh;
+    Font::GetFontSize(fx, &fw, &fh);
+
+    size_t bits{};
+    for (char c : text)
+    {
+        uint8_t pw, ph;
+        const uint8_t *glyph{Font::GetGlyph(fx, c, &pw, &ph)};
+        int bytes{(pw + 7) / 8 * ph};
+        for (int i = 0; i < bytes; i++)
+        {
+            bits += __builtin_popcount(glyph[i]);
+        }
+    }
+
+    lcd.ResetStats();
+    lcd.DrawPixel(10, 10, Color::White);
+    LCD::SPI_STATS_t pixel{lcd.GetStats()};
+
+    printf("DrawChar of %zu code chars, ILGH16XB, per char:\n", text.size());
+    printf("  per pixel loop: %zu set bits, %.1f transactions, %.1f bytes\n", bits / text.size(),
+           static_cast<double>(bits) * pixel.transactions / text.size(), static_cast<double>(bits) * pixel.bytes / text.size());
+
+    for (bool filled : {true, false})
+    {
+        if (filled)
+        {
+            lcd.SetFontFill(Color::Black);
+        }
+
+        lcd.ResetStats();
+        uint16_t x{static_cast<uint16_t>(239 - fh)}, y{10};
+        for (char c : text)
+        {
+            y = lcd.DrawChar(fx, x, y, c, Color::White);
+            if (y > 320 - fw)
+            {
+                y = 10;
+                x = x > 2 * fh ? x - fh : 239 - fh;
+            }
+        }
+        LCD::SPI_STATS_t stats{lcd.GetStats()};
+        lcd.UnsetFontFill();
+
+        printf("  %s: %.1f transactions, %.1f bytes\n", filled ? "filled window" : "set pixel runs",
+               static_cast<double>(stats.transactions) / text.size(), static_cast<double>(stats.bytes) / text.size());
+    }
+}
+
+// One 37 column row with font fill, as one strip and char by char
+static void bench_string_stats(ST7789V &lcd, FontxFile *fx)
+{
+    std::string row{code_chars(37)};
+    std::replace(row.begin(), row.end(), '\n', ' ');
+
+    uint8_t fw, fh;
+    Font::GetFontSize(fx, &fw, &fh);
+    lcd.SetFontFill(Color::Black);
+
+    lcd.ResetStats();
+    lcd.DrawString(fx, 100, 10, (uint8_t *)row.c_str(), Color::White);
+    LCD::SPI_STATS_t strip{lcd.GetStats()};
+
+    lcd.ResetStats();
+    uint16_t y{10};
+    for (char c : row)
+    {
+        y = lcd.DrawChar(fx, 100 - fh, y, c, Color::White);
+    }
+    LCD::SPI_STATS_t chars{lcd.GetStats()};
+    lcd.UnsetFontFill();
+
+    printf("Filled 37 column row, ILGH16XB:\n");
+    printf("  strip: %" PRIu32 " transactions, %" PRIu32 " bytes\n", strip.transactions, strip.bytes);
+    printf("  char by char: %" PRIu32 " transactions, %" PRIu32 " bytes\n", chars.transactions, chars.bytes);
+}
+
+// Full screen fills, second one in same color reuses fill pattern
+static void bench_fill_stats(ST7789V &lcd)
+{
+    printf("Full screen DrawFillRect:\n");
+
+    for (Color color : {Color::Blue, Color::Blue, Color::Black})
+    {
+        lcd.ResetStats();
+        lcd.DrawFillRect(0, 0, 239, 319, color);
+        LCD::SPI_STATS_t stats{lcd.GetStats()};
+
+        printf("  %s: %" PRIu32 " transactions, %" PRIu32 " bytes\n", color == Color::Blue ? "blue" : "black",
+               stats.transactions, stats.bytes);
+    }
+}
+
+// Expansion of rotated glyph rows (16 bits) into filled RGB565 pixels:
+// bit loop as drawn now, against one table lookup per nibble for the
+// color pair. Both must write same pixels.
+static bool bench_expand_kernel()
+{
+    const uint16_t fg{0xFFFF}, bg{0x0000};
+    const int rows{37 * 8}, reps{100};
+
+    uint8_t bits[rows * 2];
+    for (int i = 0; i < rows * 2; i++)
+        bits[i] = (uint8_t)(i * 73 + 19);
+
+    uint8_t lut[16][8];
+    for (int nibble = 0; nibble < 16; nibble++)
+    {
+        for (int i = 0; i < 4; i++)
+        {
+            uint16_t c = (nibble & (0x08 >> i)) ? fg : bg;
+            lut[nibble][i * 2] = (c >> 8) & 0xFF;
+            lut[nibble][i * 2 + 1] = c & 0xFF;
+        }
+    }
+
+    static uint8_t looped[rows * 16 * 2], table[rows * 16 * 2];
+    int64_t best_loop{INT64_MAX}, best_table{INT64_MAX};
+    for (int run = 0; run < 20; run++)
+    {
+        int64_t start{esp_timer_get_time()};
+        for (int rep = 0; rep < reps; rep++)
+        {
+            for (size_t i = 0; i < sizeof(looped); i += 2)
+            {
+                looped[i] = (bg >> 8) & 0xFF;
+                looped[i + 1] = bg & 0xFF;
+            }
+            for (int r = 0; r < rows; r++)
+            {
+                uint8_t *line = &looped[r * 16 * 2];
+                for (int c = 0; c < 16; c++)
+                {
+                    if (bits[r * 2 + c / 8] & (0x80 >> (c % 8)))
+                    {
+                        line[c * 2] = (fg >> 8) & 0xFF;
+                        line[c * 2 + 1] = fg & 0xFF;
+                    }
+                }
+            }
+        }
+        best_loop = std::min(best_loop, esp_timer_get_time() - start);
+
+        start = esp_timer_get_time();
+        for (int rep = 0; rep < reps; rep++)
+        {
+            for (int r = 0; r < rows; r++)
+            {
+                uint8_t *line = &table[r * 16 * 2];
+                for (int c = 0; c < 16; c += 4)
+                {
+                    uint8_t nibble = (c % 8) ? bits[r * 2 + c / 8] & 0x0F : bits[r * 2 + c / 8] >> 4;
+                    memcpy(&line[c * 2], lut[nibble], 8);
+                }
+            }
+        }
+        best_table = std::min(best_table, esp_timer_get_time() - start);
+
+        if (memcmp(looped, table, sizeof(looped)) != 0)
+            return false;
+    }
+
+    printf("Filled glyph row expansion, 16 pixels:\n");
+    printf("  bit loop: %.1f ns per row\n", best_loop * 1000.0 / (reps * rows));
+    printf("  nibble table: %.1f ns per row\n", best_table * 1000.0 / (reps * rows));
+    return true;
+}
+
+// Host time of filled rows, landscape glyphs are expanded from rotated
+// atlas. Emulator decodes transfers while they are queued, that time is
+// in it too.
+static void bench_row_time(ST7789V &lcd, FontxFile *fx)
+{
+    std::string row{code_chars(37)};
+    std::replace(row.begin(), row.end(), '\n', ' ');
+
+    uint8_t fw, fh;
+    Font::GetFontSize(fx, &fw, &fh);
+    lcd.SetFontFill(Color::Black);
+
+    int64_t best{INT64_MAX};
+    for (int run = 0; run < 20; run++)
+    {
+        int64_t start{esp_timer_get_time()};
+        for (int i = 0; i < 200; i++)
+        {
+            lcd.DrawString(fx, 239 - fh - (i * fh) % 200, 10, (uint8_t *)row.c_str(), Color::White);
+        }
+        lcd.DrawFinish();
+        best = std::min(best, esp_timer_get_time() - start);
+    }
+    lcd.UnsetFontFill();
+
+    printf("Filled 37 column row, ILGH16XB: %.1f us per row\n", best / 200.0);
+}
+
+// Bytes of one editor-like frame in both pixel formats, from panel
+// emulator frame stats: cleared screen and 13 filled rows of text
+static void bench_format_bytes(ST7789V &lcd, FontxFile *fx)
+{
+    printf("Editor frame bytes, emulator stats:\n");
+    for (LCD::PIXEL_FORMAT_t format : {LCD::PIXEL_FORMAT_RGB565, LCD::PIXEL_FORMAT_RGB444})
+    {
+        lcd.SetPixelFormat(format);
+        lcd.DrawFinish();
+        LCD::Emulator::EndFrame();
+
+        lcd.DrawFillRect(0, 0, 239, 319, Color::Black);
+        lcd.SetFontFill(Color::Black);
+        draw_rows(lcd, fx, 13 * 37);
+        lcd.UnsetFontFill();
+        lcd.DrawFinish();
+
+        LCD::Emulator::EMULATOR_STATS_t stats{LCD::Emulator::EndFrame()};
+        printf("  %s: %" PRIu32 " bytes, %" PRIu32 " pixels\n", format == LCD::PIXEL_FORMAT_RGB444 ? "RGB444" : "RGB565",
+               stats.bytes, stats.pixels);
+    }
+
+    lcd.SetPixelFormat(LCD::PIXEL_FORMAT_RGB565);
+}
+
+int main()
+{
+    ST7789V lcd{GPIO_NUM_18, GPIO_NUM_19, GPIO_NUM_33, GPIO_NUM_5, GPIO_NUM_32, GPIO_NUM_22};
+    lcd.Init(240, 320);
+    lcd.SetFontDirection(1);
+
+    int failed{};
+    failed += !bench_font_reads(lcd);
+
+    FontxFile fx16[2];
+    std::string path{std::string{FONTS_DIR} + "/ILGH16XB.FNT"};
+    Font::InitFontx(fx16, path.c_str(), "");
+    if (!fx16[0].valid)
+        return 1;
+
+    bench_glyph_stats(lcd, fx16);
+    bench_string_stats(lcd, fx16);
+    bench_fill_stats(lcd);
+    failed += !bench_expand_kernel();
+    bench_row_time(lcd, fx16);
+    bench_format_bytes(lcd, fx16);
+
+    return failed ? 1 : 0;
+}
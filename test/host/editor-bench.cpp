@@ -0,0 +1,556 @@
+#include <stdio.h>
+#include <inttypes.h>
+#include <string>
+#include <random>
+#include <memory>
+#include <vector>
+#include <map>
+#include <functional>
+#include <algorithm>
+
+#include "esp_timer.h"
+#include "display.h"
+#include "st7789v-emulator.h"
+#include "text-finder.h"
+#include "editor-scene.h"
+
+// Editor frames on host: display list counts of editor frames and edit
+// and find timings. Every edit is one display frame, drawn into panel emulator.
+// Times are host ones, they only compare paths with each other.
+
+using Display::DisplayController, Scene::EditorScene, Scene::TextBuffer, Scene::TextFinder;
+
+static const char *TAG = "EDITOR-BENCH";
+
+static int failed{};
+
+static void check(bool condition, const char *what)
+{
+    if (!condition)
+    {
+        ESP_LOGE(TAG, "Check failed: %s", what);
+        failed++;
+    }
+}
+
+// Random words in lines of 60 columns
+static std::string random_text(size_t size, uint32_t seed)
+{
+    std::mt19937 random{seed};
+    std::uniform_int_distribution<int> letter{'a', 'z'}, length{1, 9};
+
+    std::string text{};
+    size_t column{};
+    while (text.size() < size)
+    {
+        int word{length(random)};
+        for (int i = 0; i < word; i++)
+        {
+            text += static_cast<char>(letter(random));
+        }
+
+        column += word + 1;
+        text += column < 60 ? ' ' : '\n';
+        column = column < 60 ? column : 0;
+    }
+
+    text.resize(size);
+    return text;
+}
+
+// Edit is drawn in its own frame, recorded into display list or directly.
+// Returns edit time in ms without the frame flush, which draws same page
+// whichever way rows were changed.
+static double frame(DisplayController &display, const std::function<void()> &edit, bool recording = true)
+{
+    if (recording)
+    {
+        display.BeginFrame();
+    }
+    int64_t start{esp_timer_get_time()};
+    edit();
+    int64_t end{esp_timer_get_time()};
+    display.Flush();
+
+    return (end - start) / 1000.0;
+}
+
+// Best edit time of runs in ms
+static double measure(const std::function<void()> &setup, const std::function<double()> &run, int runs = 5)
+{
+    double best{1e9};
+    for (int i = 0; i < runs; i++)
+    {
+        setup();
+        best = std::min(best, run());
+    }
+
+    return best;
+}
+
+// Text finder alone, no frame
+static double timed(const std::function<void()> &run)
+{
+    int64_t start{esp_timer_get_time()};
+    run();
+    return (esp_timer_get_time() - start) / 1000.0;
+}
+
+// Editor frames of a 10KB document, done is called after each one
+static void edit_frames(DisplayController &display, bool recording, const std::function<void(const char *)> &done)
+{
+    std::string document{random_text(10 * 1024, 5)};
+    EditorScene scene{display};
+
+    frame(display, [&]()
+          { scene.Init(); scene.Open(document); }, recording);
+    done("open");
+
+    frame(display, [&]()
+          { scene.Move(Scene::Direction::Right); }, recording);
+    done("cursor right");
+
+    frame(display, [&]()
+          { scene.Type("x"); }, recording);
+    done("type char");
+
+    frame(display, [&]()
+          { scene.Move(Scene::Direction::Bottom, 12); }, recording);
+    done("scroll rows");
+
+    frame(display, [&]()
+          { scene.Select(Scene::Direction::Bottom, 3); }, recording);
+    done("select rows");
+}
+
+// Display list of editor frames: commands and pixels recorded against
+// ones drawn after overdrawn commands are dropped and fills merged
+static void bench_frame_stats(DisplayController &display)
+{
+    printf("Display list of editor frames, drawn/recorded:\n");
+    edit_frames(display, true, [&display](const char *name)
+                {
+                    Display::DisplayListStats stats{display.GetFrameStats()};
+                    printf("  %-14s %3" PRIu32 "/%-3" PRIu32 " commands, %6" PRIu32 "/%-6" PRIu32 " pixels\n", name,
+                           stats.submitted, stats.commands, stats.pixels_submitted, stats.pixels_recorded);
+                });
+}
+
+// Dropped and merged commands must leave same screen as drawing each call
+static void check_frame_screens(DisplayController &display)
+{
+    const size_t pixels{LCD::Emulator::PANEL_WIDTH * LCD::Emulator::PANEL_HEIGHT};
+    std::vector<std::vector<uint16_t>> screens{};
+
+    edit_frames(display, false, [&](const char *)
+                {
+                    const uint16_t *memory{LCD::Emulator::GetMemory()};
+                    screens.emplace_back(memory, memory + pixels);
+                });
+
+    size_t index{};
+    edit_frames(display, true, [&](const char *name)
+                {
+                    const uint16_t *memory{LCD::Emulator::GetMemory()};
+                    std::string what{std::string{name} + " frame same as drawn directly"};
+                    check(std::equal(memory, memory + pixels, screens[index++].begin()), what.c_str());
+                });
+}
+
+// Cursor moved over drawn text without frame buffer is put back from
+// tiles built from character cells, screen must match a full redraw
+static void check_cursor_tiles(DisplayController &display)
+{
+    EditorScene scene{display, false};
+    frame(display, [&]()
+          { scene.Init(); scene.Open("def area(r):\n    return 3.14 * r ** 2\n"); });
+
+    for (Scene::Direction direction : {Scene::Direction::Up, Scene::Direction::Right, Scene::Direction::Right,
+                                       Scene::Direction::Right, Scene::Direction::Up, Scene::Direction::Left})
+    {
+        frame(display, [&]()
+              { scene.Move(direction); });
+    }
+
+    const size_t pixels{LCD::Emulator::PANEL_WIDTH * LCD::Emulator::PANEL_HEIGHT};
+    const uint16_t *memory{LCD::Emulator::GetMemory()};
+    std::vector<uint16_t> moved(memory, memory + pixels);
+
+    frame(display, [&]()
+          { scene.Redraw(); });
+    check(std::equal(memory, memory + pixels, moved.begin()), "cursor moves leave same screen as redraw");
+}
+
+// Screen of document of numbered lines, 20 rows down from its start
+static std::vector<uint16_t> long_document_screen(DisplayController &display, size_t lines)
+{
+    std::string document{};
+    for (size_t i = 0; i < lines; i++)
+    {
+        document += "print(" + std::to_string(i) + ")\n";
+    }
+
+    EditorScene scene{display};
+    frame(display, [&]()
+          { scene.Init(); scene.Open(document); });
+    frame(display, [&]()
+          { scene.Move(Scene::Direction::Bottom, 20); });
+
+    const uint16_t *memory{LCD::Emulator::GetMemory()};
+    return std::vector<uint16_t>(memory, memory + LCD::Emulator::PANEL_WIDTH * LCD::Emulator::PANEL_HEIGHT);
+}
+
+// Opened document keeps ui items only for rows around page. List ending
+// label counts all content rows below page, so two documents longer
+// than kept rows must not show same label.
+static void check_list_ending(DisplayController &display)
+{
+    std::vector<uint16_t> shorter{long_document_screen(display, 60)};
+    check(shorter != long_document_screen(display, 100), "list ending counts rows not kept in ui");
+}
+
+// Text pasted into middle of document and of lines must end up in same
+// rows as when typed in order
+static void check_paste_order(DisplayController &display)
+{
+    const std::string head{"def area(r):\n    return 3.14 * r ** 2\n"}, middle{"# radius\n# in cm\n"},
+        tail{"print(area(2))\nprint(area(3))\n"};
+
+    EditorScene typed{display};
+    frame(display, [&]()
+          { typed.Init(); typed.Open(head + middle + tail); });
+
+    EditorScene document{display};
+    frame(display, [&]()
+          { document.Init(); document.Open(head + tail); });
+    frame(display, [&]()
+          { document.Move(Scene::Direction::Bottom, 2); document.Type(middle); });
+    check(document.GetContentLabels() == typed.GetContentLabels(), "document paste in middle keeps row order");
+
+    EditorScene lines{display}, typed_lines{display};
+    frame(display, [&]()
+          { typed_lines.Init(); typed_lines.OpenLines(); typed_lines.Type(head + middle + tail); });
+    frame(display, [&]()
+          { lines.Init(); lines.OpenLines(); lines.Type(head + tail); });
+    frame(display, [&]()
+          { lines.Move(Scene::Direction::Up, 2); lines.Type(middle); });
+    check(lines.GetContentLabels() == typed_lines.GetContentLabels(), "lines paste in middle keeps row order");
+}
+
+static void bench_paste(DisplayController &display)
+{
+    printf("Paste of random 60 column text, ms:\n");
+    printf("  %-6s %-10s %-10s\n", "size", "document", "lines");
+
+    for (size_t size : {1024, 10 * 1024, 100 * 1024})
+    {
+        std::string pasted{random_text(size, 1)};
+        std::unique_ptr<EditorScene> scene{};
+
+        double document_ms{measure([&]()
+                                   {
+                                       scene = std::make_unique<EditorScene>(display);
+                                       frame(display, [&]()
+                                             { scene->Init(); scene->Open(""); });
+                                   },
+                                   [&]()
+                                   { return frame(display, [&]()
+                                                  { scene->Type(pasted); }); })};
+        check(scene->GetDocumentSize() == size, "pasted document size");
+
+        double lines_ms{measure([&]()
+                                {
+                                    scene = std::make_unique<EditorScene>(display);
+                                    frame(display, [&]()
+                                          { scene->Init(); scene->OpenLines(); });
+                                },
+                                [&]()
+                                { return frame(display, [&]()
+                                               { scene->Type(pasted); }); })};
+
+        printf("  %-6s %-10.2f %-10.2f\n", size == 1024 ? "1KB" : size == 10 * 1024 ? "10KB" : "100KB", document_ms, lines_ms);
+    }
+}
+
+// Cut of 5 selected rows from middle of document, and from lines of one
+// tenth size paragraph, 20 rows from its end
+static void bench_cut(DisplayController &display)
+{
+    printf("Cut of 5 rows, ms:\n");
+    printf("  %-6s %-10s %-10s\n", "size", "document", "paragraph");
+
+    for (size_t size : {10 * 1024, 100 * 1024, 1000 * 1024})
+    {
+        std::string text{random_text(size, 2)}, paragraph{text.substr(0, size / 10)};
+        std::replace(paragraph.begin(), paragraph.end(), '\n', ' ');
+        std::unique_ptr<EditorScene> scene{};
+        auto cut{[&]()
+                 { return frame(display, [&]()
+                                { scene->Cut(); }); }};
+
+        double document_ms{measure([&]()
+                                   {
+                                       scene = std::make_unique<EditorScene>(display);
+                                       frame(display, [&]()
+                                             { scene->Init(); scene->Open(text); });
+                                       frame(display, [&]()
+                                             { scene->Move(Scene::Direction::Bottom, 20); scene->Select(Scene::Direction::Bottom, 5); });
+                                   },
+                                   cut)};
+        check(scene->GetDocumentSize() < size, "cut document size");
+
+        size_t rows{};
+        double lines_ms{measure([&]()
+                                {
+                                    scene = std::make_unique<EditorScene>(display);
+                                    frame(display, [&]()
+                                          { scene->Init(); scene->OpenLines(); scene->Type(paragraph); });
+                                    frame(display, [&]()
+                                          { scene->Move(Scene::Direction::Up, scene->GetContentLabels().size() - 20); scene->Select(Scene::Direction::Bottom, 5); });
+                                    rows = scene->GetContentLabels().size();
+                                },
+                                cut)};
+        check(scene->GetContentLabels().size() == rows - 5, "cut lines rows");
+
+        printf("  %-6s %-10.3f %-10.3f\n", size == 10 * 1024 ? "10KB" : size == 100 * 1024 ? "100KB" : "1000KB", document_ms, lines_ms);
+    }
+}
+
+// Typed chars are undone as one step only until cursor moves
+static void check_undo_merge(DisplayController &display)
+{
+    EditorScene scene{display};
+    frame(display, [&]()
+          { scene.Init(); scene.Open(""); scene.Type("a"); scene.Type("b"); });
+    frame(display, [&]()
+          { scene.Move(Scene::Direction::Left); scene.Move(Scene::Direction::Right); scene.Type("c"); });
+
+    frame(display, [&]()
+          { scene.Undo(); });
+    check(scene.GetDocumentSize() == 2, "undo after cursor move takes back only chars typed after it");
+    frame(display, [&]()
+          { scene.Undo(); });
+    check(scene.GetDocumentSize() == 0, "undo takes back typed word at once");
+}
+
+static void bench_undo(DisplayController &display)
+{
+    std::string document{random_text(100 * 1024, 2)}, pasted{random_text(10 * 1024, 3)};
+    EditorScene scene{display};
+
+    frame(display, [&]()
+          { scene.Init(); scene.Open(document); scene.Move(Scene::Direction::Bottom, 5); });
+    frame(display, [&]()
+          { scene.Type(pasted); });
+
+    double undo_ms{1e9}, redo_ms{1e9};
+    for (int i = 0; i < 5; i++)
+    {
+        undo_ms = std::min(undo_ms, frame(display, [&]()
+                                          { check(scene.Undo(), "undo"); }));
+        check(scene.GetDocumentSize() == document.size(), "undone document size");
+
+        redo_ms = std::min(redo_ms, frame(display, [&]()
+                                          { check(scene.Redo(), "redo"); }));
+        check(scene.GetDocumentSize() == document.size() + pasted.size(), "redone document size");
+    }
+
+    printf("Undo/redo of 10KB paste in 100KB document:\n");
+    printf("  undo %.2f ms, redo %.2f ms\n", undo_ms, redo_ms);
+}
+
+// Replace-all spanning less than undo journal budget is one undo step
+static void check_replace_undo(DisplayController &display)
+{
+    std::string document{random_text(6 * 1024, 6)};
+    for (size_t i = 1024; i < 5 * 1024; i += 1024)
+    {
+        document.replace(i, 6, "needle");
+    }
+
+    EditorScene scene{display};
+    frame(display, [&]()
+          { scene.Init(); scene.Open(document); });
+    frame(display, [&]()
+          { scene.Find("needle"); scene.Replace("pin"); });
+    check(scene.GetDocumentSize() == document.size() - 4 * 3, "replaced matches");
+
+    frame(display, [&]()
+          { check(scene.Undo(), "undo replace-all"); });
+    check(scene.GetDocumentSize() == document.size(), "replace-all is undone at once");
+}
+
+// Pixels of screen that are not background, taken as most common color
+static std::vector<bool> drawn_pixels(const std::vector<uint16_t> &screen)
+{
+    std::map<uint16_t, size_t> counts{};
+    for (uint16_t pixel : screen)
+    {
+        counts[pixel]++;
+    }
+
+    uint16_t background{std::max_element(counts.begin(), counts.end(), [](auto &a, auto &b)
+                                         { return a.second < b.second; })
+                            ->first};
+
+    std::vector<bool> drawn(screen.size());
+    std::transform(screen.begin(), screen.end(), drawn.begin(), [background](uint16_t pixel)
+                   { return pixel != background; });
+    return drawn;
+}
+
+// Highlighted page is drawn once by text grid. Its glyphs must be same as
+// of plain text in other colors, and same after scrolling away and back.
+static void check_highlighted_page(DisplayController &display)
+{
+    std::string document{};
+    for (int i = 0; i < 30; i++)
+    {
+        document += "def f" + std::to_string(i) + "(r):  # area\n    return \"r\" * 2\n";
+    }
+
+    const size_t pixels{LCD::Emulator::PANEL_WIDTH * LCD::Emulator::PANEL_HEIGHT};
+    const uint16_t *memory{LCD::Emulator::GetMemory()};
+
+    EditorScene plain{display};
+    frame(display, [&]()
+          { plain.Init(); plain.Open(document); });
+    std::vector<uint16_t> plain_page(memory, memory + pixels);
+
+    EditorScene scene{display};
+    frame(display, [&]()
+          { scene.Init(); scene.Open(document, CodeLanguage::Python); });
+    std::vector<uint16_t> opened(memory, memory + pixels);
+    check(opened != plain_page, "highlighted page is drawn in syntax colors");
+    check(drawn_pixels(opened) == drawn_pixels(plain_page), "highlighted page has same glyphs as plain one");
+
+    frame(display, [&]()
+          { scene.Move(Scene::Direction::Bottom, 20); });
+    frame(display, [&]()
+          { scene.Move(Scene::Direction::Up, 20); });
+    check(std::equal(memory, memory + pixels, opened.begin()), "highlighted page same after scrolling back");
+}
+
+// Keystroke in 200KB highlighted Python document, rows are lexed again
+// only up to the page end
+static void bench_highlight(DisplayController &display)
+{
+    std::string document{};
+    for (int i = 0; document.size() < 200 * 1024; i++)
+    {
+        document += "def f" + std::to_string(i) + "(r):  # area of r\n    return 3.14 * r ** 2 + len(\"abc\")\n";
+    }
+
+    EditorScene scene{display};
+    frame(display, [&]()
+          { scene.Init(); scene.Open(document, CodeLanguage::Python); scene.Move(Scene::Direction::Bottom, 4); });
+
+    double char_ms{1e9}, quote_ms{1e9};
+    for (int i = 0; i < 5; i++)
+    {
+        char_ms = std::min(char_ms, frame(display, [&]()
+                                          { scene.Type("x"); }));
+    }
+    for (int i = 0; i < 5; i++)
+    {
+        quote_ms = std::min(quote_ms, frame(display, [&]()
+                                            { scene.Type("\""); }));
+    }
+
+    printf("Keystroke in 200KB highlighted Python document:\n");
+    printf("  char %.3f ms, quote %.3f ms\n", char_ms, quote_ms);
+}
+
+// Find and replace-all in 200KB document with "needle" about every 4KB.
+// Patterns are entered through find modal, as Ctrl+F and Ctrl+H do.
+static void bench_find(DisplayController &display)
+{
+    std::string document{random_text(200 * 1024, 4)};
+    size_t matches{};
+    for (size_t i = 2048; i + 6 < document.size(); i += 4096, matches++)
+    {
+        document.replace(i, 6, "needle");
+    }
+
+    TextBuffer text{};
+    text.Assign(document.data(), document.size());
+
+    TextFinder finder{};
+    size_t found{};
+    auto find_all = [&]()
+    {
+        found = 0;
+        for (size_t match{finder.FindNext(text, 0)}; match != SIZE_MAX; match = finder.FindNext(text, match + 1))
+            found++;
+    };
+
+    finder.SetPattern("needle");
+    double bmh_ms{measure([]() {}, [&]()
+                          { return timed(find_all); })};
+    check(found == matches, "bmh match count");
+
+    double scan_ms{measure([]() {}, [&]()
+                           { return timed([&]()
+                                          {
+                                              found = 0;
+                                              for (size_t i = 0; i + 6 <= text.Size(); i++)
+                                              {
+                                                  size_t j{};
+                                                  while (j < 6 && text.At(i + j) == "needle"[j])
+                                                      j++;
+                                                  found += j == 6;
+                                              } }); })};
+    check(found == matches, "scan match count");
+
+    finder.SetPattern("q");
+    double char_ms{measure([]() {}, [&]()
+                           { return timed(find_all); })};
+
+    EditorScene scene{display};
+    frame(display, [&]()
+          { scene.Init(); scene.Open(document); });
+    frame(display, [&]()
+          { scene.Find("needle"); });
+
+    double next_ms{measure([]() {}, [&]()
+                           { return frame(display, [&]()
+                                          { check(scene.FindNext(), "find next"); }); })};
+
+    double replace_ms{measure([&]()
+                              { frame(display, [&]()
+                                      { scene.Open(document); scene.Find("needle"); }); },
+                              [&]()
+                              { return frame(display, [&]()
+                                             { scene.Replace("pin"); }); })};
+    check(scene.GetDocumentSize() == document.size() - matches * 3, "replaced document size");
+
+    printf("Find in 200KB document, %zu matches of \"needle\":\n", matches);
+    printf("  BMH scan %.2f ms, char by char %.2f ms, one char pattern %.2f ms\n", bmh_ms, scan_ms, char_ms);
+    printf("  find next %.2f ms, replace all %.2f ms\n", next_ms, replace_ms);
+}
+
+int main()
+{
+    DisplayController display{GPIO_NUM_18, GPIO_NUM_19, GPIO_NUM_33, GPIO_NUM_5, GPIO_NUM_32, GPIO_NUM_22};
+    if (display.Init() != ESP_OK)
+    {
+        ESP_LOGE(TAG, "Display init failed");
+        return 1;
+    }
+
+    check_frame_screens(display);
+    check_cursor_tiles(display);
+    check_list_ending(display);
+    check_paste_order(display);
+    check_undo_merge(display);
+    check_highlighted_page(display);
+    check_replace_undo(display);
+    bench_frame_stats(display);
+    bench_paste(display);
+    bench_cut(display);
+    bench_undo(display);
+    bench_highlight(display);
+    bench_find(display);
+
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,186 @@
+#include "editor-scene.h"
+
+namespace Scene
+{
+    EditorScene::EditorScene(DisplayController &display, bool frame_buffer)
+        : Scene(display), frame_buffer{frame_buffer} {}
+
+    EditorScene::~EditorScene()
+    {
+        display.DisableFrameBuffer();
+    }
+
+    void EditorScene::Init()
+    {
+        if (frame_buffer)
+        {
+            display.EnableFrameBuffer();
+        }
+        content_ui_start = 3;
+        InitModals();
+
+        auto &theme{Settings::Settings::GetTheme()};
+
+        ui->push_back(UiStringItem{"Code", theme.Colors.MainTextColor, display.fx32L, false});
+        display.SetPosition(&*(ui->end() - 1), Position::Center, Position::End);
+
+        ui->push_back(UiStringItem{"< Esc", theme.Colors.MainTextColor, display.fx24G});
+        display.SetPosition(&*(ui->end() - 1), Position::Start, Position::End);
+
+        ui->push_back(UiStringItem{"Run", theme.Colors.MainTextColor, display.fx24G});
+        display.SetPosition(&*(ui->end() - 1), Position::End, Position::End);
+    }
+
+    void EditorScene::RenderContent()
+    {
+        Scene::RenderContent();
+
+        if (!IsContentEndDisplayed())
+        {
+            RenderUiListEnding();
+        }
+    }
+
+    // Same as code scene, rows are moved on screen when they can be
+    uint8_t EditorScene::ScrollContent(Direction direction, bool rerender, uint8_t count)
+    {
+        count = Scene::ScrollContent(direction, rerender, count);
+
+        if (rerender && count)
+        {
+            if (RenderContentShifted())
+            {
+                if (!IsContentEndDisplayed())
+                {
+                    RenderUiListEnding();
+                }
+            }
+            else
+            {
+                RenderContent();
+            }
+        }
+
+        return count;
+    }
+
+    void EditorScene::InitModals()
+    {
+        InitFindModal((uint8_t)EditorSceneStage::FindModalStage, (uint8_t)EditorSceneStage::EditorStage);
+    }
+
+    size_t EditorScene::GetContentUiStartIndex(uint8_t stage)
+    {
+        if (stage == (uint8_t)EditorSceneStage::FindModalStage)
+        {
+            return ui->end() - 1 - ui->begin();
+        }
+
+        return content_ui_start;
+    }
+
+    // Document is read into text buffer as files scene opens a file
+    void EditorScene::Open(const std::string &document, CodeLanguage language)
+    {
+        text.Assign(document.data(), document.size());
+        OpenDocument(display.fx16G);
+        SetDocumentLanguage(language);
+
+        CursorInit(display.fx16G);
+        SetCursorControlling(true);
+        RenderAll();
+    }
+
+    // Single empty content line edited as lines, as code run log is
+    void EditorScene::OpenLines()
+    {
+        auto &theme{Settings::Settings::GetTheme()};
+
+        CursorInit(display.fx16G);
+        ui->push_back(UiStringItem{"", theme.Colors.MainTextColor, display.fx16G, false});
+        (ui->end() - 1)->x = 10;
+        (ui->end() - 1)->y = display.GetHeight() - 60;
+        ResetViewport();
+
+        SetCursorControlling(true);
+        RenderAll();
+    }
+
+    void EditorScene::Type(const std::string &chars)
+    {
+        CursorInsertChars(chars, GetLinesScroll());
+    }
+
+    void EditorScene::Move(Direction direction, size_t count)
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            MoveCursor(direction, true, GetLinesScroll());
+        }
+    }
+
+    // Selection grows from cursor, which moves with it as Ctrl+Shift+arrow does
+    void EditorScene::Select(Direction direction, size_t count)
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            Scene::Select(direction);
+            MoveCursor(direction, true, GetLinesScroll());
+        }
+    }
+
+    void EditorScene::Redraw()
+    {
+        RenderAll();
+    }
+
+    // Pattern is entered in find modal, as Ctrl+F does. Input starts with
+    // last pattern, it's deleted first.
+    void EditorScene::Find(const std::string &pattern)
+    {
+        OpenFindModal((uint8_t)EditorSceneStage::FindModalStage, false);
+        for (size_t i = 0; i < find_pattern.size(); i++)
+        {
+            Delete();
+        }
+
+        find_pattern = pattern;
+        for (char c : pattern)
+        {
+            Value(c);
+        }
+        Value('\n');
+    }
+
+    bool EditorScene::FindNext()
+    {
+        return FindText(true);
+    }
+
+    void EditorScene::Replace(const std::string &replacement)
+    {
+        OpenFindModal((uint8_t)EditorSceneStage::FindModalStage, true);
+        for (char c : replacement)
+        {
+            Value(c);
+        }
+        Value('\n');
+    }
+
+    size_t EditorScene::GetDocumentSize() const
+    {
+        return text.Size();
+    }
+
+    // Labels of content lines kept in ui, in ui order
+    std::vector<std::string> EditorScene::GetContentLabels()
+    {
+        std::vector<std::string> labels{};
+        for (auto it{GetContentUiStart()}; it < ui->end(); it++)
+        {
+            labels.push_back(it->label);
+        }
+
+        return labels;
+    }
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "scene.h"
+
+namespace Scene
+{
+    enum class EditorSceneStage
+    {
+        EditorStage,
+        FindModalStage,
+    };
+
+    // Code scene page without its modals and runner, document and
+    // edits are given by the test
+    class EditorScene : public Scene
+    {
+        bool frame_buffer;
+        std::string find_pattern{};
+
+    protected:
+        void RenderContent() override;
+        uint8_t ScrollContent(Direction direction, bool rerender = true, uint8_t count = 1) override;
+        void InitModals() override;
+        size_t GetContentUiStartIndex(uint8_t stage) override;
+
+    public:
+        EditorScene(DisplayController &display, bool frame_buffer = true);
+        void Init() override;
+
+        void Open(const std::string &document, CodeLanguage language = CodeLanguage::Text);
+        void OpenLines();
+        void Type(const std::string &chars);
+        void Move(Direction direction, size_t count = 1);
+        void Select(Direction direction, size_t count = 1);
+        using Scene::Cut, Scene::Undo, Scene::Redo;
+        void Redraw();
+        void Find(const std::string &pattern);
+        bool FindNext();
+        void Replace(const std::string &replacement);
+        size_t GetDocumentSize() const;
+        std::vector<std::string> GetContentLabels();
+
+        ~EditorScene();
+    };
+}
@@ -0,0 +1,266 @@
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include <functional>
+#include <algorithm>
+
+#include "esp_log.h"
+#include "st7789v.h"
+#include "fontx.h"
+#include "fontx-embedded.h"
+#include "st7789v-emulator.h"
+
+// Golden frame checks: known drawings go through the panel driver into
+// panel emulator, screen is compared with PPM in golden directory.
+// Run with --update to write golden frames again after intended change.
+
+using LCD::ST7789V, LCD::Color;
+
+static const char *TAG = "FRAME-TEST";
+
+static const char *font_names[]{"ILGH16XB", "ILGH24XB", "ILGH32XB", "LATIN32B", "ILMH16XB", "ILMH24XB", "ILMH32XB"};
+static FontxFile fonts[sizeof(font_names) / sizeof(font_names[0])][2];
+
+struct FrameCase
+{
+    const char *name;
+    std::function<void(ST7789V &)> draw;
+};
+
+// Landscape rows as the UI draws them: x is the row, y runs along it
+static void draw_fonts(ST7789V &lcd)
+{
+    lcd.SetFontDirection(1);
+    lcd.DrawFillRect(0, 0, 239, 319, Color::Black);
+    lcd.DrawFillRect(0, 200, 60, 319, Color::Blue);
+
+    uint16_t x{239};
+    for (size_t i = 0; i < sizeof(font_names) / sizeof(font_names[0]); i++)
+    {
+        uint8_t fw, fh;
+        Font::GetFontSize(fonts[i], &fw, &fh);
+        x -= fh;
+
+        if (i % 2)
+            lcd.SetFontFill(Color::Gray);
+        if (i == 4)
+            lcd.SetFontUnderLine(Color::Red);
+
+        lcd.DrawString(fonts[i], x, 4, (uint8_t *)(std::string{font_names[i]} + " Aq{}").c_str(), Color::White);
+
+        lcd.UnsetFontFill();
+        lcd.UnsetFontUnderLine();
+    }
+
+    lcd.DrawString(fonts[0], 20, 204, (uint8_t *)"on fill", Color::Yellow);
+}
+
+// Rows whose cells touch, in all four font directions, on a background
+// the filled cells must not reach past. Later rows would clear the first
+// pixels of earlier ones if a cell window overlapped its neighbour.
+static void draw_glyph_neighbours(ST7789V &lcd)
+{
+    FontxFile *fx{fonts[0]};
+    uint8_t fw, fh;
+    Font::GetFontSize(fx, &fw, &fh);
+
+    lcd.DrawFillRect(0, 0, 239, 319, Color::Gray);
+
+    struct Rows
+    {
+        uint16_t direction;
+        int16_t x, y;   // first row start
+        int16_t dx, dy; // to next row
+    };
+
+    int16_t step{fh};
+    for (const Rows &rows : {Rows{1, 172, 10, static_cast<int16_t>(-step), 0},
+                             Rows{0, 10, 40, 0, step},
+                             Rows{2, 120, 110, 0, step},
+                             Rows{3, 230, 310, static_cast<int16_t>(-step), 0}})
+    {
+        lcd.SetFontDirection(rows.direction);
+        lcd.SetFontFill(Color::Black);
+        lcd.DrawString(fx, rows.x, rows.y, (uint8_t *)"#Strip|row", Color::White);
+
+        // Same text char by char, each glyph in its own window
+        uint16_t x = rows.x + rows.dx, y = rows.y + rows.dy;
+        for (const char *c = "#Chars|row"; *c; c++)
+        {
+            uint16_t next = lcd.DrawChar(fx, x, y, *c, Color::Yellow);
+            if (rows.direction == 0 || rows.direction == 2)
+                x = next;
+            else
+                y = next;
+        }
+
+        lcd.SetFontFill(Color::Blue);
+        lcd.DrawString(fx, rows.x + 2 * rows.dx, rows.y + 2 * rows.dy, (uint8_t *)"#Last|row", Color::White);
+        lcd.UnsetFontFill();
+    }
+
+    // Glyph runs without fill over a rectangle
+    lcd.SetFontDirection(1);
+    lcd.DrawFillRect(4, 170, 34, 240, Color::Red);
+    lcd.DrawString(fx, 12, 174, (uint8_t *)"Runs=#|#", Color::White);
+}
+
+// Frame buffer rows shifted by one row, only the exposed row is drawn
+static void draw_shift(ST7789V &lcd)
+{
+    FontxFile *fx{fonts[0]};
+    uint8_t fw, fh;
+    Font::GetFontSize(fx, &fw, &fh);
+
+    if (!lcd.EnableFrameBuffer())
+    {
+        ESP_LOGE(TAG, "Frame buffer is not available");
+        return;
+    }
+
+    lcd.SetFontDirection(1);
+    lcd.DrawFillRect(0, 0, 239, 319, Color::Black);
+    lcd.SetFontFill(Color::Black);
+    for (int row = 0; row < 6; row++)
+    {
+        std::string line{"line " + std::to_string(row)};
+        lcd.DrawString(fx, 200 - row * fh, 10, (uint8_t *)line.c_str(), Color::White);
+    }
+    lcd.DrawFinish();
+
+    lcd.ShiftArea(200 - 5 * fh, 0, 200 + fh - 1, 319, fh);
+    lcd.DrawString(fx, 200 - 5 * fh, 10, (uint8_t *)"line 6", Color::Green);
+    lcd.UnsetFontFill();
+    lcd.DisableFrameBuffer();
+}
+
+static const FrameCase frame_cases[]{
+    {"fonts", draw_fonts},
+    {"glyph-neighbours", draw_glyph_neighbours},
+    {"shift", draw_shift},
+    {"fonts-rgb444", [](ST7789V &lcd)
+     {
+         lcd.SetPixelFormat(LCD::PIXEL_FORMAT_RGB444);
+         draw_fonts(lcd);
+         lcd.SetPixelFormat(LCD::PIXEL_FORMAT_RGB565);
+     }},
+};
+
+static bool read_file(const std::string &path, std::vector<uint8_t> &data)
+{
+    FILE *file = fopen(path.c_str(), "rb");
+    if (file == NULL)
+        return false;
+
+    uint8_t buffer[4096];
+    size_t read;
+    data.clear();
+    while ((read = fread(buffer, 1, sizeof(buffer), file)) > 0)
+    {
+        data.insert(data.end(), buffer, buffer + read);
+    }
+
+    fclose(file);
+    return true;
+}
+
+// Differing pixels and their bounds, both frames are same size PPMs
+static bool compare_frames(const char *name, const std::vector<uint8_t> &actual, const std::vector<uint8_t> &golden)
+{
+    if (actual.size() != golden.size())
+    {
+        ESP_LOGE(TAG, "%s: frame size %zu, golden %zu", name, actual.size(), golden.size());
+        return false;
+    }
+
+    size_t header{actual.size() - LCD::Emulator::PANEL_WIDTH * LCD::Emulator::PANEL_HEIGHT * 3};
+    size_t count{}, x1{SIZE_MAX}, y1{SIZE_MAX}, x2{}, y2{};
+
+    for (size_t i = header; i < actual.size(); i += 3)
+    {
+        if (memcmp(&actual[i], &golden[i], 3) == 0)
+            continue;
+
+        size_t pixel{(i - header) / 3};
+        size_t x{pixel % LCD::Emulator::PANEL_WIDTH}, y{pixel / LCD::Emulator::PANEL_WIDTH};
+        x1 = std::min(x1, x);
+        y1 = std::min(y1, y);
+        x2 = std::max(x2, x);
+        y2 = std::max(y2, y);
+        count++;
+    }
+
+    if (count)
+    {
+        ESP_LOGE(TAG, "%s: %zu pixels differ in (%zu, %zu)-(%zu, %zu)", name, count, x1, y1, x2, y2);
+    }
+
+    return count == 0;
+}
+
+int main(int argc, char **argv)
+{
+    bool updating{argc > 1 && strcmp(argv[1], "--update") == 0};
+
+    ST7789V lcd{GPIO_NUM_18, GPIO_NUM_19, GPIO_NUM_33, GPIO_NUM_5, GPIO_NUM_32, GPIO_NUM_22};
+    lcd.Init(240, 320);
+
+    // Fonts linked in, as the app draws with them
+    for (size_t i = 0; i < sizeof(font_names) / sizeof(font_names[0]); i++)
+    {
+        std::string name{std::string{font_names[i]} + ".FNT"};
+        const Fontx::FontxEmbedded *embedded{Fontx::FindEmbeddedFontx(name.c_str())};
+        if (embedded == NULL)
+        {
+            ESP_LOGE(TAG, "Font %s is not embedded", name.c_str());
+            return 1;
+        }
+
+        Font::InitEmbeddedFontx(fonts[i], embedded->name, embedded->start, embedded->end);
+        if (!fonts[i][0].valid)
+        {
+            ESP_LOGE(TAG, "Font %s can't be opened", name.c_str());
+            return 1;
+        }
+    }
+
+    int failed{};
+    for (const FrameCase &frame : frame_cases)
+    {
+        frame.draw(lcd);
+
+        std::string golden_path{std::string{GOLDEN_DIR} + "/" + frame.name + ".ppm"};
+        std::string actual_path{std::string{frame.name} + ".ppm"};
+        if (!LCD::Emulator::DumpPPM(updating ? golden_path.c_str() : actual_path.c_str()))
+        {
+            failed++;
+            continue;
+        }
+
+        if (updating)
+        {
+            printf("%s: golden frame written\n", frame.name);
+            continue;
+        }
+
+        std::vector<uint8_t> actual{}, golden{};
+        read_file(actual_path, actual);
+        if (!read_file(golden_path, golden))
+        {
+            ESP_LOGE(TAG, "%s: no golden frame %s, run with --update", frame.name, golden_path.c_str());
+            failed++;
+        }
+        else if (!compare_frames(frame.name, actual, golden))
+        {
+            ESP_LOGE(TAG, "%s: frame is kept in %s", frame.name, actual_path.c_str());
+            failed++;
+        }
+        else
+        {
+            printf("%s: ok\n", frame.name);
+        }
+    }
+
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,30 @@
+#include "keyboard.h"
+#include "runner.h"
+
+// Stand-ins for app components scenes call into, there are no keys
+// pressed and no code running on host
+
+QueueHandle_t xQueueRunnerStdout{};
+QueueHandle_t xQueueRunnerStdin{};
+SemaphoreHandle_t xDisplayingSemaphore{};
+
+namespace Keyboard
+{
+    bool KeyboardController::IsKeyPressed(Key key)
+    {
+        return false;
+    }
+}
+
+namespace CodeRunner
+{
+    bool CodeRunController::IsRunning()
+    {
+        return false;
+    }
+
+    bool CodeRunController::IsWaitingInput()
+    {
+        return false;
+    }
+}
@@ -0,0 +1,5 @@
+#pragma once
+// Host build stand-in for ESP-IDF placement attributes
+
+#define IRAM_ATTR
+#define DRAM_ATTR
@@ -0,0 +1,2 @@
+#pragma once
+// Host build stand-in for ESP-IDF CPU utilities, nothing is used
@@ -0,0 +1,31 @@
+#pragma once
+// Host build stand-in for ESP-IDF heap, all memory comes from malloc
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#define MALLOC_CAP_DEFAULT (1 << 12)
+#define MALLOC_CAP_INTERNAL (1 << 11)
+#define MALLOC_CAP_SPIRAM (1 << 10)
+#define MALLOC_CAP_DMA (1 << 3)
+#define MALLOC_CAP_8BIT (1 << 2)
+
+static inline void *heap_caps_malloc(size_t size, uint32_t caps)
+{
+    return malloc(size);
+}
+
+static inline void *heap_caps_calloc(size_t n, size_t size, uint32_t caps)
+{
+    return calloc(n, size);
+}
+
+static inline size_t heap_caps_get_free_size(uint32_t caps)
+{
+    return 0;
+}
+
+static inline uint32_t esp_get_free_heap_size()
+{
+    return 0;
+}
@@ -0,0 +1,13 @@
+#pragma once
+// Host build stand-in for ESP-IDF logging, errors and warnings go to stderr
+
+#include <stdio.h>
+#include <inttypes.h>
+
+#include "esp_err.h"
+
+#define ESP_LOGE(tag, format, ...) fprintf(stderr, "E %s: " format "\n", tag, ##__VA_ARGS__)
+#define ESP_LOGW(tag, format, ...) fprintf(stderr, "W %s: " format "\n", tag, ##__VA_ARGS__)
+#define ESP_LOGI(tag, format, ...) ((void)(tag))
+#define ESP_LOGD(tag, format, ...) ((void)(tag))
+#define ESP_LOGV(tag, format, ...) ((void)(tag))
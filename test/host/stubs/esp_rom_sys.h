@@ -0,0 +1,8 @@
+#pragma once
+// Host build stand-in for ESP-IDF ROM functions
+
+#include <stdint.h>
+
+static inline void esp_rom_delay_us(uint32_t us)
+{
+}
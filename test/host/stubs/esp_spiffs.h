@@ -0,0 +1,26 @@
+#pragma once
+// Host build stand-in for ESP-IDF SPIFFS, fonts are read from embedded data
+
+#include <stddef.h>
+#include <stdbool.h>
+
+#include "esp_err.h"
+
+typedef struct
+{
+    const char *base_path;
+    const char *partition_label;
+    size_t max_files;
+    bool format_if_mount_failed;
+} esp_vfs_spiffs_conf_t;
+
+static inline esp_err_t esp_vfs_spiffs_register(const esp_vfs_spiffs_conf_t *conf)
+{
+    return ESP_OK;
+}
+
+static inline esp_err_t esp_spiffs_info(const char *partition_label, size_t *total_bytes, size_t *used_bytes)
+{
+    *total_bytes = *used_bytes = 0;
+    return ESP_OK;
+}
@@ -0,0 +1,12 @@
+#pragma once
+// Host build stand-in for ESP-IDF timer, time since boot is monotonic clock
+
+#include <stdint.h>
+#include <time.h>
+
+static inline int64_t esp_timer_get_time()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (int64_t)now.tv_sec * 1000000 + now.tv_nsec / 1000;
+}
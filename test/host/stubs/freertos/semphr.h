@@ -0,0 +1,4 @@
+#pragma once
+// Host build stand-in for FreeRTOS semaphores
+
+#include "freertos/queue.h"
@@ -0,0 +1,15 @@
+#pragma once
+// Host build stand-in for FreeRTOS tasks
+
+#include <stddef.h>
+
+#include "freertos/FreeRTOS.h"
+
+static inline void vTaskDelay(const TickType_t ticks)
+{
+}
+
+static inline TaskHandle_t xTaskGetCurrentTaskHandle()
+{
+    return NULL;
+}
@@ -0,0 +1,33 @@
+#pragma once
+// Host build stand-in for ESP-IDF NVS, nothing is stored so defaults are used
+
+#include <stdint.h>
+
+#include "esp_err.h"
+
+typedef uint32_t nvs_handle_t;
+
+typedef enum
+{
+    NVS_READONLY,
+    NVS_READWRITE,
+} nvs_open_mode_t;
+
+static inline esp_err_t nvs_open(const char *name, nvs_open_mode_t open_mode, nvs_handle_t *out_handle)
+{
+    return ESP_ERR_NVS_NOT_FOUND;
+}
+
+static inline esp_err_t nvs_get_i8(nvs_handle_t handle, const char *key, int8_t *out_value)
+{
+    return ESP_ERR_NVS_NOT_FOUND;
+}
+
+static inline esp_err_t nvs_set_i8(nvs_handle_t handle, const char *key, int8_t value)
+{
+    return ESP_OK;
+}
+
+static inline void nvs_close(nvs_handle_t handle)
+{
+}
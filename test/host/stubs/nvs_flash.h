@@ -0,0 +1,14 @@
+#pragma once
+// Host build stand-in for ESP-IDF NVS flash
+
+#include "esp_err.h"
+
+static inline esp_err_t nvs_flash_init()
+{
+    return ESP_OK;
+}
+
+static inline esp_err_t nvs_flash_erase()
+{
+    return ESP_OK;
+}
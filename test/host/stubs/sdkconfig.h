@@ -0,0 +1,17 @@
+#pragma once
+// Host build configuration, Kconfig defaults of the components under test
+
+#define CONFIG_IDF_TARGET_LINUX 1
+
+#define CONFIG_FONTX_TABLE_MAX 4096
+#define CONFIG_FONTX_CACHE_SLOTS 32
+#define CONFIG_FONTX_EMBEDDED 1
+#define CONFIG_FONTX_ROTATED 1
+#define CONFIG_ST7789V_QUEUE_SIZE 7
+#define CONFIG_ST7789V_QUEUE_BUFFERS 3
+#define CONFIG_ST7789V_QUEUE_BUFFER_SIZE 2048
+#define CONFIG_ST7789V_FILL_PATTERN_SIZE 8192
+
+#define CONFIG_DISPLAY_LIST 1
+
+#define CONFIG_UNDO_JOURNAL_SIZE 16384
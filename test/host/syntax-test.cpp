@@ -0,0 +1,134 @@
+#include <stdio.h>
+#include <string>
+#include <vector>
+#include <random>
+
+#include "syntax-highlighter.h"
+
+// Highlighting must not depend on where rows wrap: tokens of every char
+// are compared with ones of same document lexed with no wrapped rows.
+
+using Scene::SyntaxHighlighter, Scene::SyntaxRun, Scene::SyntaxToken, Scene::TextBuffer, Scene::WrapIndex;
+
+static constexpr size_t UNWRAPPED_LINE_LENGTH{250};
+
+struct SyntaxCase
+{
+    CodeLanguage language;
+    std::string document;
+};
+
+// Tokens split by wraps: escapes, quote closers and long brackets
+static const SyntaxCase syntax_cases[]{
+    {CodeLanguage::Python, "s = 'abc\\'def' + \"x\\\\\" # end\nt = '''one\ntwo\\''' x '''\nu = 1\n"},
+    {CodeLanguage::Python, "a = '''''' b\nc = \"\"\"q\"\"\" if d else '''\\'''' \nfor x in y: pass\n"},
+    {CodeLanguage::Python, "x = '\\\ny' + 'z'\nprint(x) # '''\nz = 0.5 + .25 + 10\n"},
+    {CodeLanguage::Lua, "local s = [==[ long ]] ]==] .. 'q\\'' -- c\n--[[ comment\n]] x = 1\n"},
+    {CodeLanguage::Lua, "t = [[]] u = [=[ ]=] --[==[ a ]=] ]==] while true do end\n"},
+    {CodeLanguage::Lua, "local function f() return \"\\\"\" .. [[x]] end --[=[\n]=]\n"},
+};
+
+static bool lex_document(CodeLanguage language, const TextBuffer &text, size_t line_length, std::vector<SyntaxToken> &tokens)
+{
+    WrapIndex wrap{};
+    wrap.Build(text, line_length);
+
+    SyntaxHighlighter syntax{};
+    syntax.SetLanguage(language);
+    syntax.Build(wrap.GetRows());
+
+    tokens.clear();
+    std::vector<SyntaxRun> runs{};
+    for (size_t row = 0; row < wrap.GetRows(); row++)
+    {
+        syntax.GetRuns(text, wrap, row, runs);
+
+        size_t length{};
+        for (const SyntaxRun &run : runs)
+        {
+            tokens.insert(tokens.end(), run.length, run.token);
+            length += run.length;
+        }
+
+        if (length != wrap.GetRowLength(row))
+        {
+            printf("row %zu at line length %zu: runs cover %zu of %zu chars\n", row, line_length, length, wrap.GetRowLength(row));
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static bool check_document(const SyntaxCase &test)
+{
+    TextBuffer text{};
+    text.Assign(test.document.data(), test.document.size());
+
+    std::vector<SyntaxToken> expected{}, actual{};
+    if (!lex_document(test.language, text, UNWRAPPED_LINE_LENGTH, expected))
+        return false;
+
+    for (size_t line_length = 8; line_length < 40; line_length++)
+    {
+        if (!lex_document(test.language, text, line_length, actual))
+            return false;
+
+        for (size_t i = 0; i < expected.size(); i++)
+        {
+            if (actual[i] != expected[i])
+            {
+                printf("char %zu '%c' at line length %zu: token %d, unwrapped %d\n", i, test.document[i], line_length,
+                       static_cast<int>(actual[i]), static_cast<int>(expected[i]));
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+// Random documents dense in chars that open and close tokens
+static std::string random_document(std::mt19937 &random, size_t size)
+{
+    static const char chars[]{"'\"\\[]=-#\n .5ab if for "};
+    std::uniform_int_distribution<size_t> pick{0, sizeof(chars) - 2};
+
+    std::string document{};
+    size_t line{};
+    while (document.size() < size)
+    {
+        char c{chars[pick(random)]};
+        line = c == '\n' ? 0 : line + 1;
+        document += line < UNWRAPPED_LINE_LENGTH ? c : '\n';
+    }
+
+    return document;
+}
+
+int main()
+{
+    int failed{};
+    for (const SyntaxCase &test : syntax_cases)
+    {
+        if (!check_document(test))
+        {
+            printf("failed: %s", test.document.c_str());
+            failed++;
+        }
+    }
+
+    std::mt19937 random{1};
+    for (int i = 0; i < 200; i++)
+    {
+        SyntaxCase test{i % 2 ? CodeLanguage::Lua : CodeLanguage::Python, random_document(random, 300)};
+        if (!check_document(test))
+        {
+            printf("failed random document %d\n", i);
+            failed++;
+        }
+    }
+
+    printf("%d syntax cases failed\n", failed);
+    return failed ? 1 : 0;
+}